@@ -0,0 +1,177 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * ADC_Engine class used to sample all the analog channels in background.
+ * The conversions are triggered by Timer1 at a fixed rate and the ADC interrupt
+ * stores each result in the ring buffer of its channel, moving to the next one (round-robin).
+ * The sensor classes only have to reduce the buffered samples.
+ *
+ * Note: Timer1 is reserved for the engine. While it is running analogRead() must not be used
+ *
+ */
+#ifndef ADC_Engine_h
+#define ADC_Engine_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+
+class ADC_Engine {
+public:
+    /**
+     * Constructor
+     **/
+    ADC_Engine();
+
+    /**
+     * Add a new analog pin to the sampled channels. Only before begin(), since the rate of
+     * every channel depends on the number of channels
+     *
+     * @param pin The analog pin to sample
+     * @return The channel assigned to the pin, or -1 if it can't be added
+     **/
+    int8_t add_channel(uint8_t pin);
+
+    /**
+     * Find the channel assigned to an analog pin
+     *
+     * @param pin The analog pin to find
+     * @return The channel assigned to the pin, or -1 if the pin is not sampled
+     **/
+    int8_t find_channel(uint8_t pin);
+
+    /**
+     * Start the background sampling of all the channels added
+     **/
+    void begin();
+
+    /**
+     * Stop the background sampling and release the ADC for analogRead()
+     **/
+    void end();
+
+    /**
+     * Indicates whether the background sampling is running
+     *
+     * @return Return true if the engine is running, otherwise false
+     **/
+    bool is_running();
+
+    /**
+     * Get the number of channels added to the engine
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Set the interval between the samples stored in the ring buffer of a channel, so the
+     * latest samples span a given time instead of the last few conversions. The rest of
+     * the conversions are still accumulated (take_accum, windows)
+     *
+     * @param ch The channel to configure
+     * @param ms Interval (in ms) between the samples of the ring (0 = every conversion)
+     * @return Return true if the interval has been set, otherwise false
+     **/
+    bool set_ring_interval(uint8_t ch, uint16_t ms);
+
+    /**
+     * Get the last sample stored in the ring buffer of a channel
+     *
+     * @param ch The channel to consult
+     * @return The last ADC value (0-1023)
+     **/
+    const uint16_t get_last(uint8_t ch);
+
+    /**
+     * Copy the latest samples stored in the ring buffer of a channel
+     *
+     * @param ch The channel to consult
+     * @param buff The destination array
+     * @param max_n Maximum number of samples to copy
+     * @return The number of samples copied
+     **/
+    uint8_t read_ring(uint8_t ch, uint16_t *buff, uint8_t max_n);
+
+    /**
+     * Calculates the mean of the latest samples of a channel, discarding the lower and higher values
+     *
+     * @param ch The channel to consult
+     * @param n_samples Number of samples to use (limited to the ring size)
+     * @return The filtered mean value (ADC scale)
+     **/
+    const float get_trimmed_mean(uint8_t ch, uint8_t n_samples);
+
+    /**
+     * Get the sum of all samples converted on a channel since the last call, and restart the sum
+     *
+     * @param ch The channel to consult
+     * @param sum Where to store the sum of the samples
+     * @return The number of samples accumulated
+     **/
+    uint16_t take_accum(uint8_t ch, uint32_t &sum);
+
+    /**
+     * Get the sampling rate of each channel, given by the engine rate shared by all the channels
+     *
+     * @return The samples per second of each channel
+     **/
+    const uint16_t get_channel_rate();
+
+    /**
+     * Set a metering window on a channel. The samples are accumulated in blocks of a fixed
+     * length, with the sum and the sum of squares of each block latched by the interrupt
+     *
+     * @param ch The channel to configure
+     * @param n_samples Number of samples of each window (0 disables the windows)
+     * @return Return true if the window has been set, otherwise false
+     **/
+    bool set_window(uint8_t ch, uint16_t n_samples);
+
+    /**
+     * Get the sums of the last completed window of a channel
+     *
+     * @param ch The channel to consult
+     * @param sum Where to store the sum of the samples
+     * @param sum_sq Where to store the sum of the squared samples
+     * @param n Where to store the number of samples of the window
+     * @return The number of windows completed since the last call (0 if there are no new windows)
+     **/
+    uint8_t take_window(uint8_t ch, uint32_t &sum, uint32_t &sum_sq, uint16_t &n);
+
+    /**
+     * Conversion complete handler. Only to be called from the ADC interrupt
+     **/
+    void isr_handler();
+
+private:
+    struct ADC_channel_t {
+        uint8_t pin;                                       // Analog pin sampled
+        volatile uint16_t ring[ADC_ENG_RING_SIZE];         // Latest samples
+        volatile uint8_t head;                             // Position for the next sample
+        volatile uint8_t count;                            // Number of valid samples in ring
+        uint16_t ring_ms;                                  // Interval between the samples of the ring (0 = all)
+        uint16_t ring_every;                               // Conversions per ring sample, from ring_ms & the channel rate
+        volatile uint16_t ring_skip;                       // Conversions since the last ring sample
+        volatile uint32_t acc_sum;                         // Sum of the samples since the last take
+        volatile uint16_t acc_n;                           // Number of samples since the last take
+        volatile uint32_t acc_sq;                          // Sum of the squared samples of the window in progress
+        uint16_t win_n;                                    // Samples of each metering window (0 = disabled)
+        volatile uint32_t lat_sum;                         // Sums latched at the end of the last window
+        volatile uint32_t lat_sq;                          //
+        volatile uint8_t win_count;                        // Windows completed since the last take
+    } channels[ADC_ENG_MAX_CHANNELS];
+
+    uint8_t n_channels;
+    volatile uint8_t cur_ch;                               // Channel of the conversion in progress
+    bool running;
+
+    void select_channel(uint8_t ch);                       // Route the ADC multiplexer to a channel
+    void update_ring_every(uint8_t ch);                    // Convert the ring interval to conversions at the current rate
+};
+
+extern ADC_Engine adc_engine;                              // Unique engine shared by all the analog sensors
+
+#endif
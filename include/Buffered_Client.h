@@ -0,0 +1,79 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Buffered_Client class used to coalesce the small writes sent to a network client.
+ * It wraps any Client (Ethernet or GPRS modem) and gathers the print() output in a
+ * buffer supplied by the caller, which is sent with a single write when it is full or
+ * when flush() is called. Each chunk becomes one SPI burst / TCP segment (or one AT
+ * send command) instead of one per print() call. The reads are not buffered
+ *
+ */
+#ifndef Buffered_Client_h
+#define Buffered_Client_h
+
+#include <Arduino.h>
+#include <Client.h>
+#include "Configuration.h"
+
+
+class Buffered_Client : public Client {
+public:
+    /**
+     * Constructor
+     *
+     * @param client The client where the output is sent
+     * @param buff The buffer where the output is gathered
+     * @param size Size of the buffer (bytes sent in each chunk)
+     **/
+    Buffered_Client(Client &client, uint8_t *buff, size_t size);
+
+    virtual int connect(IPAddress ip, uint16_t port);
+    virtual int connect(const char *host, uint16_t port);
+
+    /**
+     * Add a single byte to the output. The buffer is sent when it is full
+     *
+     * @param c The byte to write
+     * @return The number of bytes written (0 if the chunk could not be sent)
+     **/
+    virtual size_t write(uint8_t c);
+
+    /**
+     * Add a block of bytes to the output. The full chunks are sent as they are completed
+     *
+     * @param buffer The bytes to write
+     * @param size Number of bytes to write
+     * @return The number of bytes written
+     **/
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    using Print::write;
+
+    virtual int available();
+    virtual int read();
+    virtual int read(uint8_t *buf, size_t size);
+    virtual int peek();
+
+    /**
+     * Send the output gathered in the buffer. Must be called at the end of each message
+     **/
+    virtual void flush();
+
+    /**
+     * Send the pending output and close the connection
+     **/
+    virtual void stop();
+
+    virtual uint8_t connected();
+    virtual operator bool();
+
+private:
+    Client &client;                                        // Client wrapped
+    uint8_t *buff;                                         // Buffer supplied by the caller
+    size_t size;                                           // Size of the buffer
+    size_t len;                                            // Bytes waiting to be sent
+};
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * CBOR_Writer class used to encode compact binary messages (RFC 7049) without dynamic memory.
+ * Only the items needed by the telemetry are supported: integers, text strings, arrays
+ * (definite and indefinite length) and maps. The items that do not fit in the buffer
+ * supplied by the caller are discarded (marking the overflow)
+ *
+ */
+#ifndef CBOR_Writer_h
+#define CBOR_Writer_h
+
+#include <Arduino.h>
+
+
+class CBOR_Writer {
+public:
+    /**
+     * Constructor
+     *
+     * @param buff The buffer where to encode the message
+     * @param size Size of the buffer
+     **/
+    CBOR_Writer(uint8_t *buff, size_t size);
+
+    /**
+     * Empty the buffer to start a new message
+     **/
+    void reset();
+
+    /**
+     * Encode an unsigned integer
+     *
+     * @param value The value to encode
+     **/
+    void put_uint(uint32_t value);
+
+    /**
+     * Encode a signed integer
+     *
+     * @param value The value to encode
+     **/
+    void put_int(int32_t value);
+
+    /**
+     * Encode a text string
+     *
+     * @param str The null-terminated string to encode
+     **/
+    void put_text(const char *str);
+
+    /**
+     * Encode the null value (e.g. a value not available)
+     **/
+    void put_null();
+
+    /**
+     * Start an array with a known number of items
+     *
+     * @param n_items Number of items of the array
+     **/
+    void begin_array(uint16_t n_items);
+
+    /**
+     * Start an array whose number of items is unknown. It must be closed with end_indef()
+     **/
+    void begin_indef_array();
+
+    /**
+     * Close the last indefinite length item
+     **/
+    void end_indef();
+
+    /**
+     * Start a map with a known number of pairs (key & value items)
+     *
+     * @param n_pairs Number of pairs of the map
+     **/
+    void begin_map(uint16_t n_pairs);
+
+    /**
+     * Get the encoded message
+     *
+     * @return The buffer with the message
+     **/
+    const uint8_t *data() const;
+
+    /**
+     * Get the length of the encoded message
+     *
+     * @return Number of bytes encoded
+     **/
+    const size_t length() const;
+
+    /**
+     * Indicates whether some item has been discarded because the buffer was full
+     *
+     * @return Return true if the message is truncated, otherwise false
+     **/
+    bool is_overflow() const;
+
+private:
+    uint8_t *buff;
+    size_t size;
+    size_t len;
+    bool overflow;
+
+    void put_head(uint8_t major, uint32_t value);         // Encode the initial byte and the argument of an item
+    void put_byte(uint8_t b);
+};
+
+#endif
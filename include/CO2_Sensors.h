@@ -0,0 +1,89 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ * 
+ * CO2_Sensors class used to control all analog CO2 sensors attached to the system
+ * 
+ */
+#ifndef CO2_Sensors_h
+#define CO2_Sensors_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+#include "OS_Sensor.h"
+#include "ADC_Engine.h"
+
+class CO2_Sensors : public OS_Sensor {
+public:
+    /**
+     * Constructor
+     **/
+    CO2_Sensors();
+
+    /**
+     * Add new CO2 sensor to the system
+     * 
+     * @param pin Where the sensor is connected (analog)
+     * @return Return true if sensor added correctly, otherwise retunrs false
+     **/
+    bool add_sensor(uint8_t pin);
+
+    /** 
+     * Read all CO2 sensors and store the values to internal array
+     **/
+    void capture_all_sensors();
+
+    /**
+     * Capture the instant CO2 value from specific sensor
+     * The value is reduced from the latest samples buffered by the ADC engine
+     * 
+     * @return The calculated instantaneous value of the read and filtered values
+     **/
+    const float get_sensor_value(uint8_t n_sensor);
+
+    /**
+     * Get the number of sensors added to the system
+     * 
+     * @return The number of sensors added to the system
+     **/
+    const uint8_t get_n_sensors();
+
+    /**
+     * Capture all the CO2 sensors. The samples are already buffered, so it finishes at once
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (one per sensor)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_CO2 for all the channels
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last CO2 value captured
+     **/
+    const float get_channel_value(uint8_t ch);
+
+private:
+    uint8_t n_sensors;                                     // Number of sensors that are added
+    uint8_t adc_ch[CO2_MAX_NUM_SENSORS];                   // ADC engine channel of each sensor
+    float arr_results[CO2_MAX_NUM_SENSORS];                // Array of read values
+
+};
+
+#endif
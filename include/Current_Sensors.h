@@ -17,9 +17,11 @@
 
 #include <Arduino.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
+#include "ADC_Engine.h"
 
 
-class Current_Sensors {
+class Current_Sensors : public OS_Sensor {
 public:
     typedef enum {                                             // Defines the type of sensor
         ACS712 = 0,                                            // Invasive sensor
@@ -43,6 +45,7 @@ public:
 
     /**
      * Get the value of the sensor captured in the instant
+     * The value is the mean of all samples taken by the ADC engine since the previous call
      * 
      * @param n_sensor Number of sensor added to the system (from 0 to N-1)
      * @return The instant value readed 
@@ -76,21 +79,85 @@ public:
     void set_volt_ref(const uint16_t _v_ref);
 
     /**
-     * Performs dump of all result values stored in the data array
+     * Configure the true-RMS metering mode. Each sensor is sampled in windows of whole mains cycles
+     * and the energy is accumulated per channel, persisted in EEPROM across reboots
      * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
-     **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+     * @param enabled Indicates whether the metering mode is active
+     * @param _mains_hz Mains frequency (in Hz)
+     * @param _voltage Nominal mains voltage (in V) used to calculate the energy
+     **/
+    void set_metering(bool enabled, uint8_t _mains_hz = CURR_METER_DEF_MAINS_HZ,
+                      uint16_t _voltage = CURR_METER_DEF_VOLTAGE);
+
+    /**
+     * Indicates whether the metering mode is active
+     * 
+     * @return Return true if the metering mode is active, otherwise false
+     **/
+    bool is_metering();
+
+    /**
+     * Process the metering windows completed by the ADC engine: update Irms and the energy counters
+     * Must be called frequently from the main loop (at least once per metering window)
+     **/
+    void poll_metering();
+
+    /**
+     * Get the energy accumulated by a sensor in metering mode
+     * 
+     * @param n_sensor Number of sensor added to the system (from 0 to N-1)
+     * @return The accumulated energy (in Wh)
+     **/
+    const float get_energy_Wh(uint8_t n_sensor);
+
+    /**
+     * Save the energy counters to the next slot of the EEPROM ring
+     **/
+    void save_energy();
+
+    /**
+     * Capture all the current sensors
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (current of each sensor, and its energy in metering mode)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_Current or ct_Energy
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the number used to identify a channel in its tag
+     *
+     * @param ch The channel to consult
+     * @return The number of the sensor (starting from 1)
+     **/
+    uint8_t get_channel_num(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last current (in A) or the energy counter (in Wh)
+     **/
+    const float get_channel_value(uint8_t ch);
     
 private:
     struct Curr_sens_t {
         Current_Model_t model;
         uint8_t  pin;
+        uint8_t  adc_ch;                                   // ADC engine channel
         uint16_t var;
     } sensors[CURR_MAX_NUM_SENSORS];
 
@@ -98,6 +165,22 @@ private:
     uint8_t n_sensors;
     float arr_current[CURR_MAX_NUM_SENSORS];               // Array of read currents
 
+    struct Curr_energy_t {                                 // Energy counters, as stored in each EEPROM slot
+        uint16_t magic;
+        uint16_t seq;                                      // Number of the save, the highest one is the latest
+        uint32_t mWh[CURR_MAX_NUM_SENSORS];                // Accumulated energy (in mWh)
+        uint8_t check;                                     // Check byte of the previous fields (torn writes)
+    } energy;
+    uint8_t ee_slot;                                       // EEPROM slot of the last save
+
+    bool metering;                                         // Indicates whether the metering mode is active
+    bool win_ready;                                        // Indicates whether the ADC windows are configured
+    uint8_t mains_hz;                                      // Mains frequency (in Hz)
+    uint16_t voltage;                                      // Nominal mains voltage (in V)
+    float win_secs;                                        // Duration of each metering window (in s)
+    float energy_frac[CURR_MAX_NUM_SENSORS];               // Fraction of mWh not yet added to the counters
+    uint32_t last_save_ms;                                 // Time (millis) of the last save to EEPROM
+
     /** 
      * Obtain current value on specific invasive sensor ACS712
      * 
@@ -113,6 +196,37 @@ private:
      * @return The instant value readed 
      **/
     const float get_current_SCT013(uint8_t n_sensor);
+
+    /**
+     * Mean of the samples converted by the ADC engine since the last capture
+     * 
+     * @param n_sensor Number of sensor added to the system (from 0 to N-1)
+     * @param mean_v Where to store the mean value (ADC scale)
+     * @return Return true if there are new samples, otherwise false
+     **/
+    bool take_mean_sample(uint8_t n_sensor, float &mean_v);
+
+    /**
+     * Convert the RMS value of a sensor signal to current, according to the sensor model
+     * 
+     * @param n_sensor Number of sensor added to the system (from 0 to N-1)
+     * @param rms_v RMS value of the signal (ADC scale, without the DC offset)
+     * @return The RMS current (in A)
+     **/
+    const float rms_to_current(uint8_t n_sensor, float rms_v);
+
+    /**
+     * Restore the energy counters of the latest valid save found in the EEPROM ring
+     **/
+    void load_energy();
+
+    /**
+     * Calculate the check byte of some energy counters
+     * 
+     * @param e The energy counters
+     * @return The XOR of all the bytes of the counters but the check byte itself
+     **/
+    uint8_t energy_check(const Curr_energy_t &e);
     
     /**
      * Read the reference voltage calculated on the MCU where the system runs (in mV)
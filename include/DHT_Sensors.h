@@ -12,9 +12,10 @@
 #include <Arduino.h>
 #include <DHT.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
 
 
-class DHT_Sensors {
+class DHT_Sensors : public OS_Sensor {
 public:
     typedef enum {
         AUTO_DETECT,
@@ -69,16 +70,42 @@ public:
     const uint8_t get_n_sensors();
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
+     * Capture all the DHT sensors
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (temperature & humidity of each sensor)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_Amb_temp or ct_Amb_hum
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the number used to identify a channel in its tag
+     *
+     * @param ch The channel to consult
+     * @return The number of the sensor (starting from 1)
+     **/
+    uint8_t get_channel_num(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last temperature or humidity captured
      **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+    const float get_channel_value(uint8_t ch);
     
 private:
     uint8_t n_sensors;
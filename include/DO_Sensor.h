@@ -13,10 +13,20 @@
 #include <Arduino.h>
 #include <BH1750.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
 
 
-class DO_Sensor {
+class DO_Sensor : public OS_Sensor {
 public:
+    enum DO_Phase_t : uint8_t {                            // Phases of an optical density scan
+        ph_preLux = 0,
+        ph_Red,
+        ph_Green,
+        ph_Blue,
+        ph_White,
+        ph_Done
+    };
+
     /**
      * Constructor
      **/
@@ -35,8 +45,49 @@ public:
 
     /**
      * Captures the values from sensor for every LED attached and store the results to internal array
+     * Blocks the MCU until the whole scan has finished
      **/
     void capture_DO();
+
+    /**
+     * Start a new optical density scan. The scan advances on each call to poll_capture()
+     * 
+     * @return Return true if the scan has been started, otherwise false
+     **/
+    bool start_capture();
+
+    /**
+     * Advance the scan in progress: switch the LEDs and take the samples when their time has come
+     * 
+     * @return Return true when the scan has finished, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Stop the scan in progress: switch off all the LEDs and discard the samples taken
+     **/
+    void abort_capture();
+
+    /**
+     * Indicates whether the last scan has finished
+     * 
+     * @return Return true if there is no scan in progress, otherwise false
+     **/
+    bool is_capture_done();
+
+    /**
+     * Get the phase of the scan in progress
+     * 
+     * @return The current phase (ph_Done if there is no scan in progress)
+     **/
+    DO_Phase_t get_phase();
+
+    /**
+     * Get the progress of the scan in progress
+     * 
+     * @return The percentage of samples taken (from 0 to 100)
+     **/
+    uint8_t get_progress();
     
     /**
      * Capture the instant lux value without any active LED
@@ -151,16 +202,35 @@ public:
     bool is_init();
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
+     * Get the number of channels published (preLux, red, green, blue & white)
+     *
+     * @return The number of channels
      **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return The type of the channel, from ct_DO_preLux to ct_DO_White
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the number used to identify a channel in its tag
+     *
+     * @param ch The channel to consult
+     * @return Always 1, there is a single DO sensor
+     **/
+    uint8_t get_channel_num(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last value captured
+     **/
+    const float get_channel_value(uint8_t ch);
 
 private:
     bool initialized;
@@ -179,8 +249,24 @@ private:
 		float B_value;
 		float W_value;
     } lux_results;
+
+    struct scan_state_t {                                  // State of the scan in progress
+        DO_Phase_t phase;                                  // Current phase
+        bool settling;                                     // Indicates whether it is waiting the LEDs to settle
+        uint32_t last_ms;                                  // Time (millis) of the phase start or the last sample
+        uint8_t n_reads;                                   // Samples taken in the current phase
+        float total_v;                                     // Accumulated values of the samples
+        float min_v;                                       // Lower sample value
+        float max_v;                                       // Higher sample value
+    } scan;
     
     const float capture_and_filter();                      // Capture a number of lux read values and calculate the mean value
+    void reset_samples();                                  // Reset the accumulated values of the samples
+    void add_sample(float read_v);                         // Accumulate a sample value
+    const float filter_samples();                          // Mean value discarding the lower and higher samples
+    void set_phase_LEDs(DO_Phase_t phase);                 // Switch on the LEDs of a phase and switch off the others
+    void store_phase_result(DO_Phase_t phase, float value);
+    void begin_phase(DO_Phase_t phase);                    // Prepare the scan for a new phase
 };
 
 #endif
@@ -14,6 +14,8 @@
 
 #include <Ethernet.h>
 #include <TinyGsmClient.h>
+#include "Modem_Session.h"
+#include "Buffered_Client.h"
 
 /**
  * Initialize the Ethernet interface with a specific MAC address
@@ -33,23 +35,46 @@ bool ETH_initialize(EthernetClass *eth, uint8_t *mac);
  * @param str_out The string data to add in GET method
  * @return returs true if the request execute correcty or false otherwise
  **/
-bool ETH_send_data_http_server(const char *host, uint16_t port, String *str_out);
+bool ETH_send_data_http_server(const char *host, uint16_t port, const char *str_out);
 
 /**
- * Initialize the modem interface
+ * Start the GPRS session of the modem. The session is established in background by MODEM_loop()
+ **/
+void MODEM_begin();
+
+/**
+ * Perform the next step of the GPRS session (connection, link check or reconnection)
+ * Must be called frequently from the main loop. Each call sends at most one AT command,
+ * waiting for its answer up to MODEM_AT_TIMEOUT_MS
+ **/
+void MODEM_loop();
+
+/**
+ * Indicates whether the GPRS session is up
  * 
- * @return returs true if the initialization execute correcty or false otherwise
+ * @return returs true if the data can be sent or false otherwise
  **/
-bool MODEM_connect_network();
+bool MODEM_is_ready();
 
 /**
- * Send a specific data by HTTP GET method
+ * Get the modem client reserved for the MQTT broker connection (its own mux channel,
+ * so it stays open while other connections are used). It is allocated on the first call,
+ * so it only takes memory when the connection is GPRS. Its connections give up after
+ * MODEM_MQTT_CONNECT_S, so a reconnection to the broker does not stall the capture cycle
+ * 
+ * @return The client of the GPRS session
+ **/
+Client &MODEM_get_mqtt_client();
+
+/**
+ * Send a specific data by HTTP GET method through the GPRS session
+ * If the session is not up the data is not sent (without waiting for the modem)
  * 
  * @param str_out The string data to add in GET method
  * @param host The address of the server to make the request
  * @param port The port of the server to make the request
  * @return returs true if the request execute correcty or false otherwise
  **/
-bool MODEM_send_data(String *str_out, const char *host, uint16_t port);
+bool MODEM_send_data(const char *str_out, const char *host, uint16_t port);
 
 #endif
@@ -0,0 +1,149 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * HTTP_Request class used to parse the requests received by the embedded web server.
+ * The parser is incremental (fed one byte at a time, in constant time) and works over
+ * fixed buffers: only the method, the target (path + query) and the values of the known
+ * headers (Connection, If-None-Match, Accept-Encoding) are stored, the rest of the headers
+ * are validated and skipped. The limits are checked as soon as they are exceeded, so the
+ * request can be answered (414/400) without reading the rest of it
+ *
+ */
+#ifndef HTTP_Request_h
+#define HTTP_Request_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+
+
+class HTTP_Request {
+public:
+    enum Parse_result_t : uint8_t {
+        pr_Incomplete = 0,                                 // More bytes are needed
+        pr_Done,                                           // Request line & headers received
+        pr_Bad_request,                                    // Malformed request or header too long (400)
+        pr_URI_too_long                                    // Target longer than ACT_WEBSRV_MAX_TARGET_LEN (414)
+    };
+
+    /**
+     * Constructor
+     **/
+    HTTP_Request();
+
+    /**
+     * Discard the request parsed to start a new one
+     **/
+    void reset();
+
+    /**
+     * Parse the next byte of the request. Once the request is done or rejected,
+     * the following bytes are ignored until reset() is called
+     *
+     * @param c The byte received
+     * @return The state of the parsing (Parse_result_t)
+     **/
+    Parse_result_t feed(char c);
+
+    /**
+     * Get the method of the request
+     *
+     * @return The null-terminated method (e.g. "GET")
+     **/
+    const char *get_method() const;
+
+    /**
+     * Get the target of the request
+     *
+     * @return The null-terminated path + query (e.g. "/action?dev=ON")
+     **/
+    const char *get_target() const;
+
+    /**
+     * Get the query of the target
+     *
+     * @return The null-terminated query (after the '?'), or an empty string if there is no query
+     **/
+    const char *get_query() const;
+
+    /**
+     * Indicates whether the method of the request is GET
+     *
+     * @return Return true if it is a GET request, otherwise false
+     **/
+    bool is_get() const;
+
+    /**
+     * Indicates whether the target starts with a string
+     *
+     * @param prefix The string stored in flash memory (F() macro)
+     * @return Return true if the target starts with the prefix, otherwise false
+     **/
+    bool target_starts_with(const __FlashStringHelper *prefix) const;
+
+    /**
+     * Indicates whether the client wants to keep the connection open after the response.
+     * By default HTTP/1.1 connections are persistent and HTTP/1.0 are not, unless the
+     * Connection header says otherwise
+     *
+     * @return Return true if the connection can be reused, otherwise false
+     **/
+    bool is_keep_alive() const;
+
+    /**
+     * Indicates whether the client already has a version of the resource (If-None-Match header)
+     *
+     * @param etag The entity tag of the current version, with the quotes (e.g. "\"12\"")
+     * @return Return true if the etag is listed in the request (or it contains "*"), otherwise false
+     **/
+    bool is_etag_cached(const char *etag) const;
+
+    /**
+     * Indicates whether the client accepts gzip compressed content (Accept-Encoding header).
+     * Without the header any encoding is accepted; "gzip;q=0" (or "*;q=0" without gzip) refuses it
+     *
+     * @return Return true if the content can be sent compressed, otherwise false
+     **/
+    bool is_gzip_accepted() const;
+
+private:
+    enum Parse_state_t : uint8_t {
+        ps_Method = 0,                                     // Method, until the first space
+        ps_Target,                                         // Target, until the second space
+        ps_Version,                                        // HTTP version, until the line end
+        ps_Header,                                         // Header lines, until an empty line
+        ps_End                                             // Done or rejected
+    };
+
+    enum Header_id_t : uint8_t {                           // Headers whose value is stored (KNOWN_HEADERS order)
+        hdr_Connection = 0,
+        hdr_If_none_match,
+        hdr_Accept_encoding,
+        hdr_N_known,
+        hdr_Unknown = 0xFF
+    };
+
+    Parse_state_t state;
+    Parse_result_t result;
+    char method[ACT_WEBSRV_MAX_METHOD_LEN+1];
+    char target[ACT_WEBSRV_MAX_TARGET_LEN+1];
+    uint8_t query_pos;                                     // Offset of the query in the target (0 if none)
+    uint16_t len;                                          // Chars of the current token or line
+    uint8_t n_headers;                                     // Header lines received
+    bool keep_alive;                                       // Persistent connection requested
+    char if_none_match[ACT_WEBSRV_HDR_VALUE_LEN+1];        // Entity tags cached by the client
+    bool accept_gzip;                                      // gzip content encoding accepted
+    bool in_value;                                         // The header name has been read (':' found)
+    uint8_t hdr_candidates;                                // Known headers (bits) still matching the name read
+    Header_id_t hdr_id;                                    // Header of the current line
+    char hdr_value[ACT_WEBSRV_HDR_VALUE_LEN+1];            // Value of the current header (if known)
+    uint8_t value_len;
+
+    void parse_header(char c);                             // Parse a char of a header line
+    void end_header();                                     // Apply the value of a known header
+    bool parse_accept_gzip(const char *value);             // gzip acceptable by an Accept-Encoding value (q > 0)
+    Parse_result_t finish(Parse_result_t res);             // Stop parsing with a final result
+};
+
+#endif
@@ -48,8 +48,9 @@ void SD_load_culture_ID(IniFile *ini, Culture_ID_st *culture_id);
  * @param ini The object that contains the IniFile class from where load the data
  * @param mqtt_pub MQTT_Pub tructure that will contain the data of the MQTT broker
  * @param culture_id Structure where store the culture data
+ * @param client The network client used to reach the broker
  **/
-void SD_load_MQTT_config(IniFile *ini, MQTT_Pub *&mqtt_pub, Culture_ID_st *culture_id);
+void SD_load_MQTT_config(IniFile *ini, MQTT_Pub *&mqtt_pub, Culture_ID_st *culture_id, Client &client);
 
 /**
  * Load the connection type to use to send data to remote server
@@ -67,29 +68,41 @@ void SD_load_Cnn_type(IniFile *ini, Internet_cnn_type &option);
  **/
 void SD_load_Eth_config(IniFile *ini, uint8_t *mac);
 
+/**
+ * Load the sampling period of a sensors group
+ * 
+ * @param ini The object that contains the IniFile class from where load the data
+ * @param section The section of the sensors group
+ * @param period_s The variable where to store the period (in seconds). Keeps its value if no config found
+ **/
+void SD_load_period(IniFile *ini, const char *section, uint16_t &period_s);
+
 /**
  * Load the DHT sensors initial configuration
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The DHT_Sensors object where to add the DHT sensors
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_DHT_sensors(IniFile *ini, DHT_Sensors *sensors);
+void SD_load_DHT_sensors(IniFile *ini, DHT_Sensors *sensors, uint16_t &period_s);
 
 /**
  * Load the DO sensor initial configuration
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensor The DO_Sensor object where to add the DO sensor
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_DO_sensor(IniFile *ini, DO_Sensor *sensor);
+void SD_load_DO_sensor(IniFile *ini, DO_Sensor *sensor, uint16_t &period_s);
 
 /**
  * Load the PH sensors initial configuration
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The PH_Sensors object where to add the PH sensor
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_pH_sensors(IniFile *ini, PH_Sensors *&sensors);
+void SD_load_pH_sensors(IniFile *ini, PH_Sensors *&sensors, uint16_t &period_s);
 
 /**
  * Extract the specific configuration for a Lux sensor from a text string
@@ -107,24 +120,27 @@ bool extract_str_params_Lux_sensor(char *str, Lux_Sensors::Lux_Sensor_model_t &m
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The Lux_Sensors object where to add the Lux sensors
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors);
+void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors, uint16_t &period_s);
 
 /**
  * Load the ORP sensors initial configuration
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The ORP_Sensors object where to add the ORP sensors
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_ORP_sensors(IniFile *ini, ORP_Sensors *&sensors);
+void SD_load_ORP_sensors(IniFile *ini, ORP_Sensors *&sensors, uint16_t &period_s);
 
 /**
  * Load the WaterProof temperature sensors initial configuration
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The WP_Temp_Sensors object where to add the WP temperature sensors
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_WP_Temp_sensors(IniFile *ini, WP_Temp_Sensors *&sensors);
+void SD_load_WP_Temp_sensors(IniFile *ini, WP_Temp_Sensors *&sensors, uint16_t &period_s);
 
 /**
  * Extract the specific configuration for a Lux sensor from a text string
@@ -146,8 +162,9 @@ bool extract_str_params_Current_sensor(char *str, uint8_t &pin, Current_Sensors:
  * 
  * @param ini The object that contains the IniFile class from where load the data
  * @param sensors The Current_Sensors object where to add the current sensors
+ * @param period_s The variable where to store the sampling period of the sensors
  **/
-void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors);
+void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors, uint16_t &period_s);
 
 /**
  * Extract the specific configuration for a actuator/device from a text string
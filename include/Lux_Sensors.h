@@ -15,8 +15,9 @@
 #include <BH1750.h>
 #include <MAX44009.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
 
-class Lux_Sensors {
+class Lux_Sensors : public OS_Sensor {
 public:
     enum Lux_Sensor_model_t : uint8_t {
         mod_UNDEFINED = 0,
@@ -80,16 +81,34 @@ public:
     Lux_Sensors::Lux_Sensor_model_t get_model_sensors(uint8_t n_sensor);
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
+     * Capture all the lux sensors
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (one per sensor)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_Lux for all the channels
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last lux value captured
      **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+    const float get_channel_value(uint8_t ch);
 
 private:
     uint8_t n_samples;                                     // Number of samples to obtain for each reading process
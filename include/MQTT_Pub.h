@@ -10,10 +10,14 @@
 #define OS_MQTT_Publisher_h
 
 #include <Arduino.h>
-#include <Ethernet.h>
+#include <Client.h>
 #include <PubSubClient.h>
 #include "Configuration.h"
 #include "OS_def_types.h"
+#include "Record_Writer.h"
+#include "CBOR_Writer.h"
+#include "Sensor_Registry.h"
+#include "OS_Actuators.h"
 
 
 class MQTT_Pub {
@@ -23,33 +27,157 @@ public:
      * 
      * @param mqtt_inf Structure that identifies the remote broker server
      * @param _culture_id Structure that identifies the culture
+     * @param client The network client used to reach the broker (EthernetClient, TinyGsmClient..)
      **/
-    MQTT_Pub(MQTT_Cnn_st *mqtt_inf, Culture_ID_st *_culture_id);
+    MQTT_Pub(MQTT_Cnn_st *mqtt_inf, Culture_ID_st *_culture_id, Client &client);
     
     /**
      * Reconnect to remote broker configured in constructor method
+     * After a failure the next attempt is delayed with exponential backoff and jitter, and
+     * the calls made before it are rejected at once (without blocking)
      * 
      * @return returns true if the process executed correctly, otherwise returns false 
      **/
     bool broker_reconnect();
+
+    /**
+     * Indicates whether the connection with the broker is up
+     * 
+     * @return returns true if connected, otherwise returns false 
+     **/
+    bool is_connected();
+
+    /**
+     * Get the number of failed connection attempts since the start
+     * 
+     * @return The number of connect failures
+     **/
+    const uint32_t get_n_connect_fails();
+
+    /**
+     * Get the time elapsed since the connection with the broker was established
+     * 
+     * @return The uptime of the connection (in seconds), 0 if not connected
+     **/
+    const uint32_t get_uptime_s();
     
     /**
      * Reconnect to remote broker configured in constructor method
      * 
+     * The fields that do not fit in a packet are split in several messages with the same
+     * tags and timestamp (the optional timestamp follows the fields separated by a space)
+     * 
      * @param payload The char array of payload for send to remote broker
      * @return returns true if the process executed correctly, otherwise returns false 
      **/
     bool publish_topic(const char *payload);
 
+    /**
+     * Add a sample to the batch pending to publish. The batch is published as a multi-line
+     * payload when it reaches the batch size or the next sample does not fit in the packet.
+     * Each line is stamped with the time of its sample
+     * 
+     * @param fields The fields of the sample (line protocol)
+     * @param timestamp Time of the sample (UNIX time in seconds). With 0 the sample is published alone, without timestamp
+     * @return MQTT_SAMPLE_SENT if the batch has been published, MQTT_SAMPLE_BUFFERED if the sample waits
+     *         in the batch or MQTT_SAMPLE_REJECTED if it could not be published nor stored
+     **/
+    int8_t add_sample(const char *fields, uint32_t timestamp);
+
+    /**
+     * Publish the samples waiting in the batch
+     * 
+     * @return returns true if the batch is empty or has been published, otherwise returns false 
+     **/
+    bool flush_batch();
+
+    /**
+     * Publish the fresh channels of the registry as a CBOR message on the topic <host>/sensors/cbor
+     * The message is a map with the keys: 0 = sequence number, 1 = timestamp (optional),
+     * 2 = [country, city, culture], 3 = [id, value, ..] absolute values, 4 = [id, difference, ..]
+     * differences against the previous message, 5 = SD queue depth (optional). The key messages
+     * (every MQTT_CBOR_KEYFRAME_EVERY and after an error) carry the tags and all the channels
+     * 
+     * @param registry The table of channels to publish
+     * @param timestamp Time of the sample (UNIX time in seconds). With 0 it is not included
+     * @param q_depth Depth of the SD queue to report. With -1 it is not included
+     * @return returns true if the message has been published, otherwise returns false 
+     **/
+    bool publish_cbor(Sensor_Registry &registry, uint32_t timestamp, int32_t q_depth = -1);
+
+    /**
+     * Get the encoding of the payload configured
+     * 
+     * @return The encoding of the payload
+     **/
+    Payload_enc_t get_encoding();
+
+    /**
+     * Attach the actuators to drive them by MQTT. The commands (ON, OFF or SWITCH) are received on
+     * <host_id>/actuators/<dev_id>/set, and the results are published back as retained messages on
+     * <host_id>/actuators/<dev_id>/state (ON | OFF) and <host_id>/actuators/<dev_id>/ack
+     * 
+     * @param actuators The actuators to drive
+     **/
+    void set_actuators(OS_Actuators *actuators);
+
+    /**
+     * Publish the current state of an actuator as a retained message
+     * 
+     * @param dev_id The ID that indentify the device/actuator
+     * @return returns true if the state has been published, otherwise returns false 
+     **/
+    bool publish_actuator_state(const char *dev_id);
+
+    /**
+     * Keep alive the connection with the broker and process incoming messages
+     * When the connection is down, the reconnection is attempted here once the backoff expires
+     * Must be called frequently from the main loop
+     **/
+    void loop();
+
 private:
-    EthernetClient eth_cli;
     PubSubClient mqtt_cli;
     MQTT_Cnn_st mqtt_inf;
 
     char pub_topic[21];
+    char cbor_topic[26];
     Culture_ID_st culture_id;
 
-    void add_tags_struct(String *str_out);
+    char prefix[MQTT_PREFIX_MAX_LEN];                      // Measurement & tags, rendered once
+    size_t prefix_len;
+
+    char batch_buff[MQTT_MAX_PACKET_SIZE];                 // Lines of the samples waiting to be published (without prefix)
+    Record_Writer batch;
+    uint8_t n_batch;                                       // Samples in the batch
+    size_t max_payload;                                    // Payload size that fits in the packet with the topic
+
+    bool session_up;                                       // The connection was up in the last check
+    uint32_t connected_ms;                                 // Time (millis) when the connection was established
+    uint32_t next_attempt_ms;                              // Time (millis) of the next reconnection attempt
+    uint8_t n_retries;                                     // Consecutive failed attempts (backoff exponent)
+    uint32_t n_connect_fails;                              // Total failed attempts
+
+    OS_Actuators *actuators;                               // Actuators driven by MQTT (NULL = none)
+    static MQTT_Pub *cmd_instance;                         // Publisher of the commands (the callback is a plain function)
+
+    int32_t cbor_ref[REG_MAX_CHANNELS];                    // Last values sent of each channel (CBOR deltas)
+    uint16_t cbor_seq;                                     // Sequence number of the CBOR messages
+    uint8_t cbor_n_delta;                                  // Messages sent with deltas since the last absolute values
+
+    void add_tags_struct(Print &out);
+    bool add_line(const char *fields, uint32_t timestamp); // Append a sample to the batch, if it fits
+    bool publish_fields(const char *fields, size_t len,
+                        uint32_t timestamp);               // Publish the fields, split in several messages if needed
+    static void on_message(char *topic, uint8_t *payload, unsigned int len);
+    void process_command(const char *topic, const uint8_t *payload, unsigned int len);
+    void subscribe_actuators();                            // Subscribe to the commands & publish the states
+    bool publish_actuator_msg(const char *dev_id, const __FlashStringHelper *leaf,
+                              const char *msg);            // Publish a retained message on the topic of the actuator
+    bool begin_msg(const char *topic, size_t len);         // Start a message of len bytes (the payload is streamed)
+    bool end_msg();                                        // Finish the message started with begin_msg()
+    size_t get_batch_payload(size_t lines_len,
+                             uint8_t n_lines);             // Size of the batch payload with the prefix of each line
 };
 
 #endif
@@ -0,0 +1,89 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Modem_Session class used to keep a long-lived GPRS session (PDP context) with the modem.
+ * The session is driven by a non-blocking state machine: each call to loop() performs at
+ * most one step (one AT command with a short timeout, MODEM_AT_TIMEOUT_MS). The slow
+ * operations (GPRS attach, PDP context activation) are requested and then polled in the
+ * next steps, so a modem stall can not freeze the sampling loop.
+ * The link health is checked periodically and the session is reestablished only on
+ * failure, with an exponential backoff between the attempts
+ *
+ */
+#ifndef Modem_Session_h
+#define Modem_Session_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+#include <TinyGsmClient.h>
+
+
+class Modem_Session {
+public:
+    enum Session_state_t : uint8_t {
+        ms_Off = 0,                                        // Session not started
+        ms_Power_up,                                       // Waiting for the modem to boot
+        ms_Restart,                                        // Modem reset (after repeated failures)
+        ms_Init,                                           // Waiting for the modem to answer, then initialization
+        ms_Wait_net,                                       // Waiting for the network registration
+        ms_Attach,                                         // GPRS attach request, then polling the attach state
+        ms_Pdp_setup,                                      // PDP context definition & activation request (one AT per step)
+        ms_Wait_pdp,                                       // Polling the PDP context state, then multi-connection mode
+        ms_Ready,                                          // GPRS session up
+        ms_Backoff                                         // Waiting before a new attempt
+    };
+
+    /**
+     * Constructor
+     *
+     * @param modem The modem used for the session
+     **/
+    Modem_Session(TinyGsm &modem);
+
+    /**
+     * Start the session. The modem serial port must be already initialized
+     **/
+    void begin();
+
+    /**
+     * Perform the next step of the session (if it is due). Must be called frequently from the main loop
+     **/
+    void loop();
+
+    /**
+     * Indicates whether the GPRS session is up
+     *
+     * @return Return true if the data can be sent, otherwise false
+     **/
+    bool is_ready();
+
+    /**
+     * Notify a failure using the session (e.g. a connection to the server refused),
+     * so the link health is checked in the next step
+     **/
+    void report_failure();
+
+    /**
+     * Get the state of the session
+     *
+     * @return The state of the session
+     **/
+    Session_state_t get_state();
+
+private:
+    TinyGsm *modem;
+    Session_state_t state;
+    uint32_t next_step_ms;                                 // Time (millis) when the next step is due
+    uint32_t wait_start_ms;                                // Time (millis) when the current wait started
+    uint8_t n_fails;                                       // Consecutive failed attempts
+    uint8_t sub_step;                                      // AT command of the multi-command states
+
+    void set_state(Session_state_t new_state, uint32_t delay_ms);
+    void fail();                                           // Schedule a new attempt with backoff
+    bool is_attached();                                    // Query the GPRS attach state (AT+CGATT?)
+    bool is_pdp_active();                                  // Query the PDP context state (AT+CGACT?)
+};
+
+#endif
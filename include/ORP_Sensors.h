@@ -14,9 +14,10 @@
 #include <Arduino.h>
 #include "Wire.h"
 #include "Configuration.h"
+#include "OS_Sensor.h"
 
 
-class ORP_Sensors {
+class ORP_Sensors : public OS_Sensor {
 public:
     /**
      * Constructor
@@ -32,11 +33,31 @@ public:
     bool add_sensor(uint8_t addr);
 
     /** 
-     * Read all current sensors and store the values to internal array
-     * 
+     * Read all ORP sensors and store the values to internal array
+     * All the probes convert at the same time, so the cost is a single read window
      **/
     void capture_all_sensors();
 
+    /**
+     * Sends the read command to every configured probe without waiting for the results
+     * 
+     * @return Return true if the command has been sent, otherwise false
+     **/
+    bool request_all();
+
+    /**
+     * Indicates whether the probes have had time to complete the read command
+     * 
+     * @return Return true if the results are ready to be collected, otherwise false
+     **/
+    bool is_ready();
+
+    /**
+     * Read back the response of every probe, store the values to internal array
+     * and put the probes to sleep
+     **/
+    void collect_all();
+
     /**
      * Get the instant value of the probe sensor
      * 
@@ -53,22 +74,52 @@ public:
     const uint8_t get_n_sensors();
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
+     * Request a read to all the probes, which convert in parallel
+     *
+     * @return Return false if there are no sensors, otherwise true
      **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+    bool start_capture();
+
+    /**
+     * Collect the results once the read window of the probes has elapsed
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (one per probe)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_ORP for all the channels
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last ORP value captured (in mV)
+     **/
+    const float get_channel_value(uint8_t ch);
     
 private:
     uint8_t n_sensors;
+    bool req_pending;                                       // Indicates whether there is a read command in progress
+    uint32_t req_start_ms;                                  // Time (millis) when the read command was sent
     
     uint8_t addr_sensors[ORP_MAX_SENSORS];                  // Array of ORP sensors
     int16_t val_sensors[ORP_MAX_SENSORS];                   // Array of read values (Range +/-2000mV)
+
+    void send_command(uint8_t addr, const char *cmd);       // Send a text command to the probe
+    const int16_t read_response(uint8_t addr);              // Read the response of a read command (in mV)
 };
 
 #endif
@@ -0,0 +1,142 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * OS_Scheduler class used to run the sensors acquisition as cooperative tasks.
+ * Each task runs the start/poll phases of a sensor, so the main loop can keep
+ * attending other jobs (web server, MQTT keepalive, LCD) while the sensors convert.
+ * Every task has its own sampling period (rate group), so a cycle only launches the due tasks
+ *
+ */
+#ifndef OS_Scheduler_h
+#define OS_Scheduler_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+#include "OS_Sensor.h"
+
+
+class OS_Scheduler {
+public:
+    enum Task_state_t : uint8_t {
+        st_Idle = 0,
+        st_Running,
+        st_Done,
+        st_Timeout
+    };
+
+    /**
+     * Constructor
+     **/
+    OS_Scheduler();
+
+    /**
+     * Add a new task to the scheduler
+     *
+     * @param name Name of the task (used for debug messages)
+     * @param period_s Sampling period of the task (in seconds)
+     * @param sensor The sensor to capture. Its start phase is called at the beginning of the cycle
+     *               and its poll phase on each pass until it returns true
+     * @param timeout_ms Deadline (in ms) for the task since the cycle started
+     * @return The number of the task added, or -1 if it can't be added
+     **/
+    int8_t add_task(const __FlashStringHelper *name, uint16_t period_s, OS_Sensor *sensor,
+                    uint16_t timeout_ms = SCHED_DEF_TASK_TIMEOUT);
+
+    /**
+     * Start a new acquisition cycle, launching the start phase of the tasks whose period has expired
+     *
+     * @return The number of tasks launched in the cycle
+     **/
+    uint8_t start_cycle();
+
+    /**
+     * Performs a single pass over the running tasks. Must be called repeatedly
+     * until it returns true
+     *
+     * @return Return true when all tasks of the cycle have finished, otherwise false
+     **/
+    bool run();
+
+    /**
+     * Indicates whether there is a cycle in progress
+     *
+     * @return Return true if some task is still running, otherwise false
+     **/
+    bool is_running();
+
+    /**
+     * Get the state of a specific task
+     *
+     * @param n_task Number of task added to the scheduler (from 0 to N-1)
+     * @return The current state of the task
+     **/
+    Task_state_t get_task_state(uint8_t n_task);
+
+    /**
+     * Indicates whether a task has obtained new results in the last cycle
+     *
+     * @param n_task Number of task added to the scheduler (from 0 to N-1)
+     * @return Return true if the task finished in time during the last cycle, otherwise false
+     **/
+    bool is_fresh(int8_t n_task);
+
+    /**
+     * Get the number of tasks that have obtained new results in the last cycle
+     *
+     * @return The number of fresh tasks
+     **/
+    const uint8_t get_n_fresh();
+
+    /**
+     * Get the time remaining until the next task is due
+     *
+     * @return Time (in ms) until the next cycle must be started (0 if some task is already due,
+     *         DELAY_SECS_NEXT_READ if there are no tasks)
+     **/
+    uint32_t get_ms_to_next_due();
+
+    /**
+     * Get the number of tasks added to the scheduler
+     *
+     * @return The number of tasks added to the scheduler
+     **/
+    const uint8_t get_n_tasks();
+
+    /**
+     * Get the number of tasks still running in the current cycle
+     *
+     * @return The number of pending tasks
+     **/
+    const uint8_t get_n_pending();
+
+    /**
+     * Get the time spent by the last finished cycle
+     *
+     * @return Duration of the last cycle (in ms)
+     **/
+    const uint32_t get_cycle_ms();
+
+private:
+    struct Sched_task_t {
+        const __FlashStringHelper *name;
+        OS_Sensor *sensor;
+        uint16_t timeout_ms;
+        uint32_t period_ms;                                // Sampling period of the task
+        uint32_t next_due_ms;                              // Time (millis) when the task must be launched again
+        Task_state_t state;
+        bool fresh;                                        // The task has new results in the last cycle
+    } tasks[SCHED_MAX_TASKS];
+
+    uint8_t n_tasks;                                       // Number of tasks added to the scheduler
+    uint8_t n_pending;                                     // Number of tasks running in the current cycle
+    uint8_t n_fresh;                                       // Number of tasks with new results in the current cycle
+    uint32_t cycle_start_ms;                               // Time (millis) when the current cycle started
+    uint32_t cycle_ms;                                     // Duration of the last finished cycle
+
+    void finish_task(uint8_t n_task, bool timed_out);      // Close a task, updating the cycle counters
+    bool is_due(uint8_t n_task, uint32_t now);             // Check if the period of a task has expired
+};
+
+#endif
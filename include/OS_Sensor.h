@@ -0,0 +1,73 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * OS_Sensor interface shared by all the sensor classes.
+ * The acquisition is split in start/poll phases run by the scheduler, and the results
+ * are exposed as channels (type + number), so the sensor registry can capture, publish,
+ * log and display any sensor in the same way
+ *
+ */
+#ifndef OS_Sensor_h
+#define OS_Sensor_h
+
+#include <Arduino.h>
+#include "OS_def_types.h"
+
+
+class OS_Sensor {
+public:
+    /**
+     * Launch the acquisition of all the sensors
+     *
+     * @return Return false if there is nothing to capture, otherwise true
+     **/
+    virtual bool start_capture() { return true; }
+
+    /**
+     * Advance the acquisition. Called repeatedly until it returns true
+     *
+     * @return Return true when all the results are available, otherwise false
+     **/
+    virtual bool poll_capture() = 0;
+
+    /**
+     * Abandon the acquisition in progress (e.g. when its deadline has expired),
+     * leaving the hardware in a safe state. By default there is nothing to undo
+     **/
+    virtual void abort_capture() {}
+
+    /**
+     * Get the number of channels (values) published by the sensors
+     *
+     * @return The number of channels
+     **/
+    virtual const uint8_t get_n_channels() = 0;
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult (from 0 to N-1)
+     * @return The type of the channel
+     **/
+    virtual Channel_type_t get_channel_type(uint8_t ch) = 0;
+
+    /**
+     * Get the number used to identify a channel in its tag (T1_s, pH2, ..)
+     *
+     * @param ch The channel to consult (from 0 to N-1)
+     * @return The number of the channel (starting from 1)
+     **/
+    virtual uint8_t get_channel_num(uint8_t ch) { return ch + 1; }
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult (from 0 to N-1)
+     * @return The value of the channel
+     **/
+    virtual const float get_channel_value(uint8_t ch) = 0;
+};
+
+#endif
@@ -11,8 +11,10 @@
 
 #include <Arduino.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
+#include "ADC_Engine.h"
 
-class PH_Sensors {
+class PH_Sensors : public OS_Sensor {
 public:
     /**
      * Constructor
@@ -34,6 +36,7 @@ public:
 
     /**
      * Capture the instant PH value from specific sensor
+     * The value is reduced from the latest samples buffered by the ADC engine
      * 
      * @return The calculated instantaneous value of the read and filtered values
      **/
@@ -61,21 +64,40 @@ public:
     const uint8_t get_n_samples();
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
+     * Capture all the pH sensors. The samples are already buffered, so it finishes at once
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (one per sensor)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_pH for all the channels
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last pH value captured
      **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+    const float get_channel_value(uint8_t ch);
 
 private:
     uint8_t n_sensors;                                     // Number of sensors that are added
     uint8_t n_samples;                                     // Number of samples to obtain for each reading process
     uint8_t pin_sensors[PH_MAX_NUM_SENSORS];               // Array of pH sensors
+    uint8_t adc_ch[PH_MAX_NUM_SENSORS];                    // ADC engine channel of each sensor
     float arr_results[PH_MAX_NUM_SENSORS];                 // Array of read values
 
 };
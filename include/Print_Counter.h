@@ -0,0 +1,54 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Print_Counter class used to measure the output of the print() calls without sending it.
+ * The web server renders the dynamic pages twice, first over a Print_Counter to get the
+ * Content-Length (needed by the keep-alive connections) and then over the client
+ *
+ */
+#ifndef Print_Counter_h
+#define Print_Counter_h
+
+#include <Arduino.h>
+
+
+class Print_Counter : public Print {
+public:
+    /**
+     * Constructor
+     **/
+    Print_Counter();
+
+    /**
+     * Count a single char
+     *
+     * @param c The char written
+     * @return Always 1
+     **/
+    virtual size_t write(uint8_t c);
+
+    /**
+     * Count a block of chars
+     *
+     * @param buffer The chars written
+     * @param size Number of chars written
+     * @return The number of chars counted
+     **/
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    using Print::write;
+
+    /**
+     * Get the number of chars written since the creation
+     *
+     * @return Number of chars counted
+     **/
+    const size_t get_count() const;
+
+private:
+    size_t count;                                          // Chars written
+};
+
+#endif
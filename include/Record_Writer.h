@@ -0,0 +1,94 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Record_Writer class used to compose the sensors records without dynamic memory.
+ * It is a Print sink over a fixed char buffer supplied by the caller, so all the
+ * print() overloads can be used to format the values. The text is kept null-terminated
+ * and the writes that do not fit in the buffer are discarded (marking the overflow)
+ *
+ */
+#ifndef Record_Writer_h
+#define Record_Writer_h
+
+#include <Arduino.h>
+
+
+class Record_Writer : public Print {
+public:
+    /**
+     * Constructor
+     *
+     * @param buff The buffer where to compose the record
+     * @param size Size of the buffer (including the null terminator)
+     **/
+    Record_Writer(char *buff, size_t size);
+
+    /**
+     * Write a single char at the end of the record. The null chars are ignored
+     *
+     * @param c The char to write
+     * @return The number of chars written (0 if the buffer is full)
+     **/
+    virtual size_t write(uint8_t c);
+
+    /**
+     * Write a block of chars at the end of the record
+     *
+     * @param buffer The chars to write
+     * @param size Number of chars to write
+     * @return The number of chars written
+     **/
+    virtual size_t write(const uint8_t *buffer, size_t size);
+
+    using Print::write;
+
+    /**
+     * Empty the record to start a new one
+     **/
+    void reset();
+
+    /**
+     * Cut the record to a previous length, discarding the chars written after it
+     *
+     * @param len The new length of the record
+     **/
+    void truncate(size_t len);
+
+    /**
+     * Get the record composed
+     *
+     * @return The null-terminated record
+     **/
+    const char *c_str() const;
+
+    /**
+     * Get the length of the record
+     *
+     * @return Number of chars written (without the null terminator)
+     **/
+    const size_t length() const;
+
+    /**
+     * Indicates whether the record is empty
+     *
+     * @return Return true if nothing has been written since the last reset, otherwise false
+     **/
+    bool is_empty() const;
+
+    /**
+     * Indicates whether some write has been discarded because the buffer was full
+     *
+     * @return Return true if the record is truncated, otherwise false
+     **/
+    bool is_overflow() const;
+
+private:
+    char *buff;                                            // Buffer supplied by the caller
+    size_t size;                                           // Size of the buffer
+    size_t len;                                            // Chars written
+    bool overflow;                                         // Some write has been discarded
+};
+
+#endif
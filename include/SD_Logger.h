@@ -0,0 +1,90 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * SD_Logger class used to write the sensors records to the SD card keeping the file open.
+ * The records are accumulated in a sector buffer (512 bytes) and written to the card
+ * aligned to the sectors of the file. The directory entry is only updated (sync) every
+ * flush interval, so at most the records of that interval can be lost on a power failure
+ *
+ */
+#ifndef SD_Logger_h
+#define SD_Logger_h
+
+#include <Arduino.h>
+#include <SD.h>
+#include "Configuration.h"
+
+
+class SD_Logger {
+public:
+    /**
+     * Constructor
+     **/
+    SD_Logger();
+
+    /**
+     * Open the log file in append mode and keep it open
+     *
+     * @param filename The name of the file where to write the records
+     * @param flush_secs Maximum time (in seconds) that the records can stay in memory without being synced to the card
+     * @return Return true if the file has been opened, otherwise false
+     **/
+    bool begin(const char *filename, uint16_t flush_secs = SD_LOG_DEF_FLUSH_SECS);
+
+    /**
+     * Append a record (a line of text) to the log
+     *
+     * @param record The null-terminated record to write. The line end is added
+     * @return Return true if the record has been stored, otherwise false
+     **/
+    bool write_record(const char *record);
+
+    /**
+     * Sync the buffered records to the card once the flush interval has expired
+     * Must be called frequently from the main loop
+     **/
+    void loop();
+
+    /**
+     * Write the buffered records and update the file directory entry
+     * Must be called before any planned reset or removal of the card
+     *
+     * @return Return true if the data has been written, otherwise false
+     **/
+    bool flush();
+
+    /**
+     * Flush the buffered records and close the file
+     **/
+    void end();
+
+    /**
+     * Indicates whether the log file is open
+     *
+     * @return Return true if the file is open, otherwise false
+     **/
+    bool is_open();
+
+    /**
+     * Get the number of bytes waiting in the sector buffer
+     *
+     * @return The bytes buffered
+     **/
+    const uint16_t get_buffered();
+
+private:
+    File log_file;
+    bool opened;
+    uint8_t buff[SD_LOG_SECTOR_SIZE];                      // Sector buffer
+    uint16_t buff_len;                                     // Bytes stored in the buffer
+    uint16_t buff_limit;                                   // Bytes to complete the current sector of the file
+    uint32_t flush_ms;                                     // Flush interval
+    uint32_t last_flush_ms;                                // Time (millis) of the last sync to the card
+
+    bool write_byte(uint8_t c);                            // Store a byte, writing the sector when it is complete
+    bool write_buffer();                                   // Write the buffered bytes to the file
+};
+
+#endif
@@ -0,0 +1,82 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * SD_Queue class used to store on the SD card the records that could not be published.
+ * The queue is an append-only file (one record per line) with a read cursor saved in a
+ * second file, so the pending records survive the reboots. When all the records have
+ * been sent, both files are removed and the queue starts again from the beginning
+ *
+ */
+#ifndef SD_Queue_h
+#define SD_Queue_h
+
+#include <Arduino.h>
+#include <SD.h>
+#include "Configuration.h"
+
+
+class SD_Queue {
+public:
+    /**
+     * Constructor
+     **/
+    SD_Queue();
+
+    /**
+     * Load the read cursor and count the pending records of the queue
+     *
+     * @param max_kb Maximum size (in KB) of the queue file. When it is reached, the new records are discarded
+     * @return Return true if the queue is ready, otherwise false
+     **/
+    bool begin(uint16_t max_kb = SD_QUEUE_DEF_MAX_KB);
+
+    /**
+     * Append a record at the end of the queue
+     *
+     * @param record The null-terminated record to store (without line end)
+     * @return Return true if the record has been stored, otherwise false
+     **/
+    bool enqueue(const char *record);
+
+    /**
+     * Read the next pending record. The record is not removed until pop() is called
+     *
+     * @param buff Buffer where the record is returned (null-terminated)
+     * @param size Size of the buffer. The longer records are truncated
+     * @return The length of the record, or -1 if there are no more pending records
+     **/
+    int16_t read_next(char *buff, size_t size);
+
+    /**
+     * Remove the last record returned by read_next() from the queue
+     **/
+    void pop();
+
+    /**
+     * Save the read cursor and close the queue file. Must be called at the end of each drain
+     * The records read and not popped will be returned again by read_next()
+     **/
+    void commit();
+
+    /**
+     * Get the number of records waiting in the queue
+     *
+     * @return The depth of the queue
+     **/
+    const uint32_t get_depth();
+
+private:
+    bool ready;
+    File rd_file;                                          // Open only while the queue is drained
+    uint32_t max_size;                                     // Maximum size of the queue file (bytes)
+    uint32_t cursor;                                       // Offset of the first pending record
+    uint32_t read_pos;                                     // Offset of the next record to read
+    uint32_t n_read;                                       // Records read and not popped
+    uint32_t depth;                                        // Pending records
+
+    bool save_cursor();                                    // Write the cursor file
+};
+
+#endif
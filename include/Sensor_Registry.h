@@ -0,0 +1,204 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Sensor_Registry class used to handle all the sensors through a single table of channels.
+ * Each sensor registered becomes a scheduler task, and each of its values a channel.
+ * The channels are stored as a struct of arrays (type, number, owner & latest value),
+ * while the metadata of each channel type (tag, unit, precision & LCD label) lives in PROGMEM.
+ * Capture, publishing, logging and display iterate the same table
+ *
+ */
+#ifndef Sensor_Registry_h
+#define Sensor_Registry_h
+
+#include <Arduino.h>
+#include "Configuration.h"
+#include "OS_def_types.h"
+#include "OS_Sensor.h"
+#include "OS_Scheduler.h"
+#include "Record_Writer.h"
+#include "CBOR_Writer.h"
+
+
+class Sensor_Registry {
+public:
+    /**
+     * Constructor
+     *
+     * @param sched The scheduler that runs the acquisition of the sensors
+     **/
+    Sensor_Registry(OS_Scheduler *sched);
+
+    /**
+     * Register a sensor object and all its channels
+     *
+     * @param name Name of the sensor (used for debug messages)
+     * @param sensor The sensor object to register
+     * @param period_s Sampling period of the sensor (in seconds)
+     * @param timeout_ms Deadline (in ms) for the acquisition since the cycle started
+     * @return Return true if the sensor has been registered, otherwise false
+     **/
+    bool add_sensor(const __FlashStringHelper *name, OS_Sensor *sensor, uint16_t period_s,
+                    uint16_t timeout_ms = SCHED_DEF_TASK_TIMEOUT);
+
+    /**
+     * Copy to the table the values of the sensors captured in the last cycle.
+     * The table keeps these values (the snapshot of the cycle) until the next update
+     *
+     * @param timestamp Time of the capture (UNIX time in seconds, 0 if unknown)
+     **/
+    void update(uint32_t timestamp = 0);
+
+    /**
+     * Performs dump of the channels stored in the table
+     *
+     * @param out The record writer where the results are appended
+     * @param print_tag Indicates whether the label of each channel should be displayed
+     * @param print_value Indicates whether the value of each channel should be displayed
+     * @param delim Character that indicates the separator of the fields shown
+     * @param only_fresh Indicates whether only the channels captured in the last cycle should be included
+     **/
+    void bulk_results(Record_Writer &out, bool print_tag = true, bool print_value = true,
+                      char delim = ',', bool only_fresh = false);
+
+    /**
+     * Performs dump of the channels stored in the table as pairs of channel ID & fixed point value
+     * (the value multiplied by 10^precision). Optionally, the difference with a reference value is
+     * encoded instead of the value, so the slow changing channels take a single byte.
+     * The invalid values (NaN, inf or out of range) are encoded as null and keep the reference, so the
+     * next difference is taken against the last valid value (in absolute messages it restarts from 0)
+     *
+     * @param out The CBOR writer where the pairs are appended
+     * @param ref Reference value of each channel (fixed point), updated with the values encoded. Can be NULL
+     * @param delta Indicates whether the difference with the reference should be encoded
+     * @param only_fresh Indicates whether only the channels captured in the last cycle should be included
+     **/
+    void bulk_cbor(CBOR_Writer &out, int32_t *ref = NULL, bool delta = false, bool only_fresh = false);
+
+    /**
+     * Performs dump of the channels stored in the table as a JSON object:
+     * {"<tag>":{"value":<value>,"unit":"<unit>"},...}. The invalid values are written as null
+     *
+     * @param out The output where the object is written
+     **/
+    void bulk_json(Print &out);
+
+    /**
+     * Get the number of updates of the table (capture cycles) since the start
+     *
+     * @return The number of the last cycle stored
+     **/
+    const uint32_t get_update_count();
+
+    /**
+     * Get the time of the last update of the table
+     *
+     * @return UNIX time in seconds of the values stored, 0 if unknown
+     **/
+    const uint32_t get_update_time();
+
+    /**
+     * Get the number of channels registered
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Find the channel of a specific type and number
+     *
+     * @param type The type of the channel
+     * @param num The number of the channel (starting from 1)
+     * @return The channel found, or -1 if it does not exist
+     **/
+    int8_t find_channel(Channel_type_t type, uint8_t num);
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return The type of the channel
+     **/
+    Channel_type_t get_type(uint8_t ch);
+
+    /**
+     * Get the ID of a channel, which is the same in all the boards: type * 16 + number
+     *
+     * @param ch The channel to consult
+     * @return The ID of the channel
+     **/
+    const uint8_t get_channel_id(uint8_t ch);
+
+    /**
+     * Get the latest value stored for a channel
+     *
+     * @param ch The channel to consult
+     * @return The value of the channel
+     **/
+    const float get_value(uint8_t ch);
+
+    /**
+     * Indicates whether a channel has been captured in the last cycle
+     *
+     * @param ch The channel to consult
+     * @return Return true if the value is fresh, otherwise false
+     **/
+    bool is_fresh(uint8_t ch);
+
+    /**
+     * Get the number of decimals used to show the value of a channel
+     *
+     * @param ch The channel to consult
+     * @return The number of decimals
+     **/
+    const uint8_t get_precision(uint8_t ch);
+
+    /**
+     * Print the tag of a channel (T1_s, pH2, ..)
+     *
+     * @param out Where to print the tag
+     * @param ch The channel to consult
+     **/
+    void print_channel_tag(Print &out, uint8_t ch);
+
+    /**
+     * Print the unit of a channel
+     *
+     * @param out Where to print the unit
+     * @param ch The channel to consult
+     **/
+    void print_channel_unit(Print &out, uint8_t ch);
+
+    /**
+     * Get the label used to show a channel on the LCD
+     *
+     * @param ch The channel to consult
+     * @param label Where to store the label
+     * @param size Size of the label buffer
+     * @return Return true if the channel must be shown on the LCD, otherwise false
+     **/
+    bool get_lcd_label(uint8_t ch, char *label, uint8_t size);
+
+private:
+    OS_Scheduler *sched;
+
+    OS_Sensor *sensors[REG_MAX_SENSORS];                   // Sensor objects registered
+    int8_t sens_task[REG_MAX_SENSORS];                     // Scheduler task of each sensor object
+    uint8_t sens_first_ch[REG_MAX_SENSORS];                // First channel of each sensor object in the table
+    uint8_t n_sensors;
+
+    // Table of channels (struct of arrays)
+    Channel_type_t ch_type[REG_MAX_CHANNELS];              // Type of the channel (index of the metadata)
+    uint8_t ch_num[REG_MAX_CHANNELS];                      // Number of the channel in its tag
+    uint8_t ch_sensor[REG_MAX_CHANNELS];                   // Sensor object that owns the channel
+    float ch_value[REG_MAX_CHANNELS];                      // Latest value of the channel
+    uint8_t n_channels;
+    uint32_t n_updates;                                    // Capture cycles stored in the table
+    uint32_t update_time;                                  // Time of the last update
+
+    void print_P_label(Print &out, const char *label_P, uint8_t num);   // Print a PROGMEM label replacing '#' by the number
+};
+
+#endif
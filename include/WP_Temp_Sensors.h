@@ -12,9 +12,10 @@
 #include <Arduino.h>
 #include <DallasTemperature.h>
 #include "Configuration.h"
+#include "OS_Sensor.h"
 
 
-class WP_Temp_Sensors {
+class WP_Temp_Sensors : public OS_Sensor {
 public:
     struct Sensor_pairs_t {
         uint8_t s_sensor[8];                                      // Defines the surface sensor address
@@ -49,6 +50,7 @@ public:
      * 
      * @param s_sensor Address of the surface sensor to be inserted
      * @param b_sensor Address of the background sensor to be inserted
+     * @param resolution Resolution (from 9 to 12 bits) applied to both sensors of the pair
      * @return Returns:
      *             0 if sensor added correctly
      *             1 if the surface sensor not connected
@@ -56,12 +58,41 @@ public:
      *             3 no more pairs of the allowed ones can be inserted 
      **/
     WP_Sensor_error_t add_sensors_pair(const uint8_t* s_sensor, 
-                                        const uint8_t* b_sensor);
+                                        const uint8_t* b_sensor,
+                                        uint8_t resolution = WP_T_DEF_RESOLUTION);
 
     /** 
      * Read all temperature sensors and store the values to internal array
+     * Blocks the MCU until the conversion has finished
      **/
     void store_all_results();
+
+    /**
+     * Sends the command for all devices on the bus to start a temperature conversion
+     * without waiting for it. The results are collected later with collect_results()
+     * 
+     * @return Return true if the conversion has been requested, otherwise false
+     **/
+    bool request_conversion();
+
+    /**
+     * Indicates whether the conversion time of the requested conversion has elapsed
+     * 
+     * @return Return true if the results are ready to be collected, otherwise false
+     **/
+    bool is_conversion_done();
+
+    /**
+     * Read the converted temperatures and store the values to internal array
+     **/
+    void collect_results();
+
+    /**
+     * Get the time needed to convert the temperatures, given by the highest resolution of the pairs
+     * 
+     * @return The conversion time (in ms)
+     **/
+    const uint16_t get_conversion_ms();
     
 
     /* Return result from sensor pair. n_sensor=1: return surface value, n_sensor!=2: return background value */
@@ -107,22 +138,58 @@ public:
     bool is_init();
 
     /**
-     * Performs dump of all result values stored in the data array
-     * 
-     * @param str Pointer to String where the results are stored
-     * @param reset Indicates whether the text string will be cleaned before entering data
-     * @param print_tag Indicates whether the label of each sensor should be displayed
-     * @param print_value Indicates whether the value of each sensor should be displayed
-     * @param delim Character that indicates the separator of the fields shown
-     **/
-    void bulk_results(String &str, bool reset = true, bool print_tag = true,
-                        bool print_value = true, char delim = ',');
+     * Start the temperature conversion on all the sensors
+     *
+     * @return Return false if there are no sensors, otherwise true
+     **/
+    bool start_capture();
+
+    /**
+     * Collect the temperatures once the conversion has finished
+     *
+     * @return Return true when the results are available, otherwise false
+     **/
+    bool poll_capture();
+
+    /**
+     * Get the number of channels published (surface & background of each pair)
+     *
+     * @return The number of channels
+     **/
+    const uint8_t get_n_channels();
+
+    /**
+     * Get the type of a channel
+     *
+     * @param ch The channel to consult
+     * @return ct_WP_temp_s or ct_WP_temp_b
+     **/
+    Channel_type_t get_channel_type(uint8_t ch);
+
+    /**
+     * Get the number used to identify a channel in its tag
+     *
+     * @param ch The channel to consult
+     * @return The number of the pair (starting from 1)
+     **/
+    uint8_t get_channel_num(uint8_t ch);
+
+    /**
+     * Get the last value captured on a channel
+     *
+     * @param ch The channel to consult
+     * @return The last temperature captured
+     **/
+    const float get_channel_value(uint8_t ch);
     
 private:
     OneWire* oneWireObj;                                          // One Wire control protocol
     DallasTemperature* sensors_ds18;                              // Control DS18 sensors
     uint8_t n_pairs;                                              // Number of pair sensors that are added
     bool initialized;                                             // Indicates whether the object has been initialized or not 
+    bool conv_pending;                                            // Indicates whether there is a conversion in progress
+    uint32_t conv_start_ms;                                       // Time (millis) when the conversion was requested
+    uint16_t conv_ms;                                             // Time needed for the conversion with the current resolutions
 
     Sensor_pairs_t sensors_pairs[WP_T_MAX_PAIRS_SENS];
     float arr_s_results[WP_T_MAX_PAIRS_SENS];                     // Array of read values from surface
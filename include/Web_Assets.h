@@ -0,0 +1,88 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Static assets of the web server, gzip compressed.
+ * GENERATED by tools/build_web_assets.py from web/ -- do not edit
+ *
+ */
+#ifndef Web_Assets_h
+#define Web_Assets_h
+
+#include <Arduino.h>
+
+#define WEB_STATUS_PAGE_GZ_LEN 1107                        // status.html: 1107 bytes (2320 uncompressed)
+#define WEB_STATUS_PAGE_GZ_ETAG "\"46a1c25c\""             // Changes with the content
+const uint8_t WEB_STATUS_PAGE_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x56, 0x6d, 0x6f, 0xdb, 0x36,
+    0x10, 0xfe, 0xae, 0x5f, 0xc1, 0x28, 0x58, 0x25, 0xaf, 0xb6, 0x95, 0xa4, 0x58, 0xb7, 0xe9, 0xc5,
+    0x43, 0x97, 0xd8, 0x4b, 0x86, 0x34, 0x19, 0x92, 0x14, 0xd8, 0x30, 0x0c, 0x01, 0x4d, 0x9e, 0x2d,
+    0xa2, 0x34, 0xa9, 0x91, 0x94, 0x9d, 0xc0, 0xf0, 0x7f, 0xdf, 0x51, 0x92, 0xed, 0xa4, 0xc9, 0x80,
+    0x61, 0x9b, 0x01, 0x43, 0xd2, 0xf1, 0x5e, 0x9e, 0xbb, 0x7b, 0x78, 0x64, 0x7e, 0x70, 0x76, 0x7d,
+    0x7a, 0xf7, 0xdb, 0x2f, 0x63, 0x52, 0xba, 0x85, 0x1c, 0x05, 0xb9, 0x7f, 0x10, 0x49, 0xd5, 0xbc,
+    0x08, 0x41, 0x85, 0x5e, 0x00, 0x94, 0xe3, 0x63, 0x01, 0x8e, 0x12, 0x56, 0x52, 0x63, 0xc1, 0x15,
+    0xe1, 0xa7, 0xbb, 0xc9, 0xe0, 0xbb, 0x70, 0x2b, 0x56, 0x74, 0x01, 0x45, 0xb8, 0x14, 0xb0, 0xaa,
+    0xb4, 0x71, 0x21, 0x61, 0x5a, 0x39, 0x50, 0xa8, 0xb6, 0x12, 0xdc, 0x95, 0x05, 0x87, 0xa5, 0x60,
+    0x30, 0x68, 0x3e, 0xfa, 0x42, 0x09, 0x27, 0xa8, 0x1c, 0x58, 0x46, 0x25, 0x14, 0xc7, 0xde, 0x87,
+    0x13, 0x4e, 0xc2, 0xe8, 0xd6, 0x51, 0x07, 0x44, 0xcf, 0x88, 0x2b, 0x81, 0xb0, 0x5a, 0xba, 0xda,
+    0x00, 0xa1, 0xcc, 0xd5, 0xd4, 0x69, 0x63, 0xf3, 0xa4, 0xd5, 0x0a, 0x72, 0xeb, 0x1e, 0xfd, 0xf3,
+    0xeb, 0xf5, 0x0c, 0xa3, 0x0c, 0x66, 0x74, 0x21, 0xe4, 0x63, 0x6a, 0xa9, 0xb2, 0x03, 0x0b, 0x46,
+    0xcc, 0x36, 0x81, 0xa3, 0x53, 0x09, 0xeb, 0x26, 0x5a, 0x7a, 0x7c, 0x74, 0xf4, 0x55, 0xa6, 0x97,
+    0x60, 0x66, 0x52, 0xaf, 0xd2, 0x52, 0x70, 0x0e, 0x2a, 0x9b, 0x52, 0xf6, 0x79, 0x6e, 0x74, 0xad,
+    0x78, 0x7a, 0x38, 0x99, 0x4c, 0x32, 0xa6, 0xa5, 0x36, 0xe9, 0xe1, 0xd1, 0xbb, 0x6f, 0xdf, 0x4d,
+    0xbf, 0xc9, 0xa6, 0xda, 0x70, 0x30, 0x03, 0x14, 0x4a, 0x5a, 0x59, 0x48, 0xb7, 0x2f, 0x9d, 0x63,
+    0x84, 0xd7, 0xef, 0x5e, 0xf8, 0xba, 0xa2, 0x9c, 0x0b, 0x35, 0x4f, 0x8f, 0x61, 0xb1, 0x5f, 0x5e,
+    0xb7, 0x1e, 0xd2, 0xe3, 0xea, 0x81, 0x58, 0x2d, 0x05, 0x27, 0x4d, 0x94, 0x7d, 0xd4, 0xc1, 0xf3,
+    0x80, 0xdd, 0x97, 0xd7, 0x71, 0xf0, 0xe0, 0x06, 0x54, 0x8a, 0xb9, 0x4a, 0x25, 0xcc, 0xdc, 0xce,
+    0x27, 0x7f, 0xc5, 0xe7, 0xf4, 0x7b, 0x78, 0x3f, 0x9b, 0xed, 0x54, 0x4c, 0xaa, 0x5c, 0x39, 0x60,
+    0xa5, 0x90, 0x3c, 0xd6, 0x9c, 0xf7, 0xd6, 0x2f, 0xe3, 0x71, 0x0a, 0x6c, 0xf6, 0x7e, 0x13, 0x0c,
+    0x59, 0x79, 0x6f, 0xb1, 0xda, 0x6b, 0x56, 0x1b, 0x8b, 0x0b, 0x95, 0x16, 0xd8, 0x2f, 0xd3, 0x46,
+    0xe7, 0xc0, 0xb4, 0xa1, 0x4e, 0x68, 0x95, 0xa2, 0x29, 0x18, 0x29, 0x14, 0xa6, 0x9e, 0x27, 0x5d,
+    0xd9, 0x73, 0xcb, 0x8c, 0xa8, 0xdc, 0x28, 0x98, 0xd5, 0x8a, 0x79, 0x2d, 0x02, 0x96, 0xc5, 0xb6,
+    0x47, 0xd6, 0x81, 0x01, 0x6c, 0x99, 0x22, 0xb7, 0xce, 0x60, 0x49, 0x50, 0x34, 0x34, 0x50, 0x49,
+    0xca, 0x20, 0x4e, 0x7e, 0x7f, 0x93, 0x8f, 0xc2, 0xe8, 0x8f, 0x64, 0xde, 0x27, 0x3b, 0xb3, 0x98,
+    0xa1, 0x0d, 0xe9, 0x6c, 0xa2, 0x37, 0x87, 0x11, 0x79, 0x4b, 0xd8, 0xd0, 0x13, 0xec, 0x54, 0x73,
+    0xf8, 0xe0, 0xe2, 0xa3, 0x1e, 0x4a, 0xa2, 0x2c, 0xca, 0xc8, 0xa6, 0x97, 0x05, 0x9b, 0x7d, 0x40,
+    0x0b, 0x8a, 0xdf, 0x23, 0x31, 0x62, 0xfc, 0xdf, 0x0b, 0xde, 0xf7, 0x24, 0x41, 0xb9, 0x87, 0xb0,
+    0xa4, 0x86, 0x3c, 0x94, 0x86, 0x14, 0x44, 0xc1, 0x8a, 0xfc, 0xfa, 0xf1, 0xf2, 0xdc, 0xb9, 0xea,
+    0x06, 0xfe, 0xac, 0xc1, 0xba, 0x18, 0xbd, 0xe0, 0xda, 0xd0, 0x89, 0x05, 0xe8, 0xda, 0xa1, 0xce,
+    0xc9, 0x11, 0xfe, 0x5a, 0xa1, 0xae, 0x40, 0xc5, 0xe1, 0x4f, 0xe3, 0xbb, 0xb0, 0x4f, 0xc2, 0xa4,
+    0x75, 0xf8, 0x43, 0x88, 0x00, 0x40, 0x31, 0x84, 0xf3, 0xe9, 0xe6, 0xe2, 0x54, 0x2f, 0x2a, 0xad,
+    0x90, 0xd5, 0x5d, 0x58, 0x8f, 0x2e, 0x2c, 0xbc, 0x4a, 0xab, 0xdd, 0xc7, 0x16, 0xd4, 0xd0, 0xc5,
+    0xd0, 0x4a, 0x6a, 0xca, 0x31, 0xc4, 0x3e, 0x5d, 0x0f, 0x4f, 0xcc, 0x48, 0xec, 0x97, 0x7d, 0xf1,
+    0x6b, 0x4b, 0x8a, 0xa2, 0xc1, 0xe0, 0xeb, 0x80, 0x7b, 0xc1, 0xb8, 0x38, 0xba, 0x81, 0x85, 0xc6,
+    0x4d, 0x60, 0xc0, 0x62, 0x2c, 0xe4, 0x1e, 0xf1, 0x55, 0xf1, 0x16, 0x5b, 0xc9, 0x1d, 0xb6, 0xa8,
+    0x97, 0x11, 0xef, 0xfd, 0xbe, 0xf5, 0x82, 0x69, 0x91, 0x4d, 0x00, 0xd2, 0xc2, 0xde, 0xcd, 0xd8,
+    0x18, 0x6d, 0x0e, 0x0e, 0x76, 0xd6, 0xad, 0x66, 0x67, 0xbb, 0x09, 0x36, 0x5b, 0x90, 0xe0, 0xf5,
+    0xbe, 0x44, 0xf9, 0xcf, 0x9c, 0xb4, 0x2e, 0x7c, 0x2b, 0x62, 0x55, 0x4b, 0xf9, 0xbc, 0x43, 0xcf,
+    0xe0, 0xfd, 0x8f, 0x6d, 0xa9, 0x44, 0xd2, 0x7a, 0x0d, 0xff, 0x45, 0xb5, 0x0f, 0xb6, 0xd5, 0x6e,
+    0x39, 0x97, 0x35, 0xa8, 0xac, 0x0f, 0xf8, 0xf3, 0xed, 0xf5, 0xd5, 0xb0, 0xf2, 0x93, 0x2d, 0x7e,
+    0x51, 0xeb, 0x3e, 0x61, 0xa8, 0x61, 0xdd, 0xb0, 0x9b, 0x48, 0x7d, 0x62, 0xf4, 0x0a, 0x5b, 0x47,
+    0xa2, 0x28, 0x0b, 0xb8, 0x66, 0xf5, 0x02, 0x29, 0x31, 0x9c, 0x83, 0x1b, 0x4b, 0xf0, 0xaf, 0x3f,
+    0x3e, 0x5e, 0xf0, 0x38, 0xea, 0x94, 0xa3, 0xde, 0x50, 0x28, 0xac, 0xf2, 0xf9, 0xdd, 0xc7, 0x4b,
+    0x52, 0x04, 0x51, 0x3e, 0x1d, 0x9d, 0xe2, 0x86, 0x74, 0xe6, 0x31, 0x25, 0x79, 0x32, 0x1d, 0xf9,
+    0xd2, 0xfa, 0xed, 0x83, 0xbc, 0x6f, 0xc5, 0x0d, 0xe5, 0xf3, 0xa9, 0x19, 0x79, 0x4d, 0xe1, 0x5e,
+    0xaa, 0xa1, 0x0c, 0x75, 0x82, 0x9d, 0x4e, 0x1b, 0xe7, 0x85, 0x5a, 0x2b, 0x7e, 0xea, 0xed, 0x5c,
+    0x63, 0xaa, 0x17, 0x67, 0x5f, 0x6a, 0x96, 0x28, 0xf6, 0x64, 0xce, 0x02, 0x4c, 0x71, 0x37, 0x6c,
+    0x87, 0x33, 0x6d, 0xc6, 0x94, 0x95, 0xf1, 0xbe, 0xa0, 0x74, 0xdb, 0x47, 0xe1, 0x0b, 0xed, 0x8d,
+    0xe9, 0xb0, 0xb1, 0x6b, 0xca, 0xf1, 0x16, 0xeb, 0x91, 0x3b, 0x0c, 0xe4, 0x78, 0xe3, 0x1c, 0x95,
+    0x7c, 0xe8, 0x04, 0x3f, 0xb7, 0xa2, 0xd6, 0xc4, 0xf7, 0xa2, 0xc3, 0x95, 0xb4, 0x0b, 0x98, 0x8b,
+    0xe3, 0x84, 0x49, 0x6a, 0x6d, 0x11, 0x76, 0x83, 0x29, 0x24, 0x9c, 0x3a, 0x3a, 0x10, 0xbc, 0x08,
+    0xf7, 0xde, 0x3a, 0x21, 0x82, 0x2c, 0xc2, 0xeb, 0xab, 0x70, 0x74, 0x8b, 0xdc, 0x23, 0xd7, 0x57,
+    0xff, 0xcd, 0xcf, 0x64, 0xb2, 0x75, 0x34, 0x99, 0xb4, 0x70, 0x13, 0x4c, 0x03, 0x5b, 0xeb, 0x67,
+    0xce, 0xdf, 0xb6, 0x77, 0x57, 0xa8, 0xe7, 0x0d, 0x6e, 0xa8, 0x91, 0x05, 0xaf, 0xee, 0x8d, 0x9d,
+    0x2f, 0x3c, 0x31, 0xc6, 0x4b, 0x7c, 0xb9, 0x14, 0x16, 0xcf, 0x48, 0x30, 0x48, 0x16, 0x29, 0xd8,
+    0xe7, 0xe8, 0xe9, 0x68, 0x84, 0x6d, 0xb1, 0x3d, 0x3b, 0x61, 0xe8, 0xa8, 0x41, 0x04, 0x59, 0x43,
+    0x68, 0x24, 0xa2, 0x4f, 0xf1, 0x0a, 0x4f, 0xdc, 0x66, 0x7e, 0x44, 0x5d, 0xaa, 0x51, 0x6f, 0x3f,
+    0x17, 0x1b, 0xc0, 0x1f, 0x1c, 0xce, 0xe1, 0x69, 0xed, 0x20, 0x8e, 0xba, 0x22, 0x44, 0x48, 0xe6,
+    0x57, 0x97, 0xd0, 0x26, 0xea, 0xf5, 0xda, 0x9c, 0x57, 0x42, 0x71, 0xbd, 0xda, 0x6f, 0xa9, 0x27,
+    0x5b, 0x39, 0xf3, 0xa7, 0x40, 0x37, 0xfd, 0xf3, 0xa4, 0xbb, 0x16, 0x4c, 0x35, 0x7f, 0xf4, 0x97,
+    0x84, 0x93, 0x1d, 0x17, 0x71, 0xe9, 0x04, 0x25, 0x5c, 0x2c, 0x89, 0x2f, 0x7c, 0xc7, 0xc5, 0x10,
+    0x2b, 0x8b, 0x22, 0x6f, 0x61, 0xfc, 0x91, 0xef, 0x0f, 0x2d, 0xff, 0x6c, 0xdc, 0xb4, 0xd4, 0x29,
+    0x47, 0x67, 0xcd, 0x45, 0x01, 0x69, 0x8a, 0x5d, 0x28, 0x1b, 0x49, 0x73, 0x29, 0xd8, 0x7e, 0xe1,
+    0xbd, 0x42, 0xda, 0x8a, 0xaa, 0x22, 0x3c, 0x09, 0x47, 0xa7, 0x25, 0xde, 0x51, 0x80, 0xd8, 0xbd,
+    0x82, 0xef, 0x9c, 0x7f, 0x6b, 0x81, 0x39, 0x8f, 0xac, 0x41, 0xb0, 0xeb, 0x96, 0xc7, 0xe0, 0x3a,
+    0xc0, 0xc9, 0x16, 0x41, 0xb2, 0x15, 0xb4, 0xf7, 0x9f, 0xbf, 0x00, 0xf5, 0xc2, 0x41, 0xbd, 0x10,
+    0x09, 0x00, 0x00,
+};
+
+#endif
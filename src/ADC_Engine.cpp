@@ -0,0 +1,281 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * ADC_Engine class used to sample all the analog channels in background.
+ * The conversions are triggered by Timer1 at a fixed rate and the ADC interrupt
+ * stores each result in the ring buffer of its channel, moving to the next one (round-robin).
+ * The sensor classes only have to reduce the buffered samples.
+ *
+ */
+
+#include "ADC_Engine.h"
+
+ADC_Engine adc_engine;
+
+
+ADC_Engine::ADC_Engine() {
+    n_channels = 0;
+    cur_ch     = 0;
+    running    = false;
+}
+
+int8_t ADC_Engine::add_channel(uint8_t pin) {
+    int8_t ch = find_channel(pin);
+    if (ch >= 0) return ch;                                // The pin is already sampled (shared by several sensors)
+
+    if (running || n_channels >= ADC_ENG_MAX_CHANNELS) return -1;   // A new channel would change the rate of the others
+
+    uint8_t sreg = SREG;                                   // The ISR must not see a half initialized channel
+    cli();
+    channels[n_channels].pin     = pin;
+    channels[n_channels].head    = 0;
+    channels[n_channels].count   = 0;
+    channels[n_channels].ring_ms = 0;
+    channels[n_channels].ring_every = 1;
+    channels[n_channels].ring_skip = 0;
+    channels[n_channels].acc_sum = 0;
+    channels[n_channels].acc_n   = 0;
+    channels[n_channels].acc_sq  = 0;
+    channels[n_channels].win_n   = 0;
+    channels[n_channels].win_count = 0;
+    n_channels++;
+    SREG = sreg;
+
+    return n_channels - 1;
+}
+
+int8_t ADC_Engine::find_channel(uint8_t pin) {
+    for (uint8_t i=0; i<n_channels; i++) {
+        if (channels[i].pin == pin)
+            return i;
+    }
+
+    return -1;
+}
+
+void ADC_Engine::begin() {
+    if (running || n_channels == 0) return;
+
+    for (uint8_t i=0; i<n_channels; i++)                   // The channel rate is final now
+        update_ring_every(i);
+
+#if defined(__AVR__)
+    cur_ch = 0;
+    select_channel(cur_ch);
+
+    // Timer1 in CTC mode (TOP = OCR1A) with prescaler 8. The compare match B triggers each conversion
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS11);
+    OCR1A  = (F_CPU / 8 / ADC_ENG_SAMPLE_HZ) - 1;
+    OCR1B  = OCR1A;
+    TCNT1  = 0;
+    TIMSK1 = 0;
+    TIFR1  = _BV(OCF1B);
+
+    // ADC auto trigger by Timer1 compare match B, conversion complete interrupt and prescaler 128 (125 KHz)
+    ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2) | _BV(ADTS0);
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+
+    running = true;
+#endif
+}
+
+void ADC_Engine::end() {
+    if (!running) return;
+
+#if defined(__AVR__)
+    ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);   // Back to single conversion, as Arduino init() leaves it
+    ADCSRB &= ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0));
+    TCCR1B = _BV(CS11) | _BV(CS10);                        // Timer1 back to the Arduino PWM configuration
+    TCCR1A = _BV(WGM10);
+#endif
+
+    running = false;
+}
+
+bool ADC_Engine::is_running() {
+    return running;
+}
+
+const uint8_t ADC_Engine::get_n_channels() {
+    return n_channels;
+}
+
+bool ADC_Engine::set_ring_interval(uint8_t ch, uint16_t ms) {
+    if (ch >= n_channels) return false;
+
+    channels[ch].ring_ms = ms;
+    if (running) update_ring_every(ch);                    // Otherwise it is done by begin()
+
+    return true;
+}
+
+const uint16_t ADC_Engine::get_last(uint8_t ch) {
+    if (ch >= n_channels || channels[ch].count == 0) return 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t pos = channels[ch].head;
+    uint16_t value = channels[ch].ring[pos? pos-1 : ADC_ENG_RING_SIZE-1];
+    SREG = sreg;
+
+    return value;
+}
+
+uint8_t ADC_Engine::read_ring(uint8_t ch, uint16_t *buff, uint8_t max_n) {
+    if (ch >= n_channels) return 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t n = min(max_n, (uint8_t)channels[ch].count);
+    uint8_t pos = channels[ch].head;
+
+    for (uint8_t i=0; i<n; i++) {                          // Copy from the newest to the oldest sample
+        pos = pos? pos-1 : ADC_ENG_RING_SIZE-1;
+        buff[i] = channels[ch].ring[pos];
+    }
+    SREG = sreg;
+
+    return n;
+}
+
+const float ADC_Engine::get_trimmed_mean(uint8_t ch, uint8_t n_samples) {
+    uint16_t buff[ADC_ENG_RING_SIZE];
+    uint8_t n = read_ring(ch, buff, n_samples);
+
+    if (n == 0) return 0;
+
+    uint32_t total_v = 0;
+    uint16_t min_v = buff[0], max_v = buff[0];
+    for (uint8_t i=0; i<n; i++) {
+        total_v += buff[i];
+
+        if (buff[i] < min_v) min_v = buff[i];              // Update de min value
+        if (buff[i] > max_v) max_v = buff[i];              // Update de max value
+    }
+
+    if (n <= 2) return (float)total_v / n;
+
+    return (float)(total_v - min_v - max_v) / (n-2);       // Discards lower and higher value for the average
+}
+
+uint16_t ADC_Engine::take_accum(uint8_t ch, uint32_t &sum) {
+    if (ch >= n_channels) {
+        sum = 0;
+        return 0;
+    }
+
+    uint8_t sreg = SREG;
+    cli();
+    sum = channels[ch].acc_sum;
+    uint16_t n = channels[ch].acc_n;
+    channels[ch].acc_sum = 0;
+    channels[ch].acc_n = 0;
+    SREG = sreg;
+
+    return n;
+}
+
+const uint16_t ADC_Engine::get_channel_rate() {
+    if (n_channels == 0) return 0;
+
+    return ADC_ENG_SAMPLE_HZ / n_channels;
+}
+
+bool ADC_Engine::set_window(uint8_t ch, uint16_t n_samples) {
+    if (ch >= n_channels || n_samples > ADC_ENG_MAX_WINDOW) return false;
+
+    uint8_t sreg = SREG;
+    cli();
+    channels[ch].win_n     = n_samples;
+    channels[ch].acc_sum   = 0;
+    channels[ch].acc_sq    = 0;
+    channels[ch].acc_n     = 0;
+    channels[ch].win_count = 0;
+    SREG = sreg;
+
+    return true;
+}
+
+uint8_t ADC_Engine::take_window(uint8_t ch, uint32_t &sum, uint32_t &sum_sq, uint16_t &n) {
+    if (ch >= n_channels || channels[ch].win_n == 0) return 0;
+
+    uint8_t sreg = SREG;
+    cli();
+    uint8_t windows = channels[ch].win_count;
+    sum    = channels[ch].lat_sum;
+    sum_sq = channels[ch].lat_sq;
+    n      = channels[ch].win_n;
+    channels[ch].win_count = 0;
+    SREG = sreg;
+
+    return windows;
+}
+
+void ADC_Engine::isr_handler() {
+#if defined(__AVR__)
+    uint16_t value = ADC;
+    ADC_channel_t *c = &channels[cur_ch];
+
+    if (++c->ring_skip >= c->ring_every) {                 // Store the sample in the ring buffer (decimated)
+        c->ring_skip = 0;
+        c->ring[c->head] = value;
+        if (++c->head >= ADC_ENG_RING_SIZE) c->head = 0;
+        if (c->count < ADC_ENG_RING_SIZE) c->count++;
+    }
+
+    if (c->win_n) {                                        // Metering window: integer sum & sum of squares
+        c->acc_sum += value;
+        c->acc_sq  += (uint32_t)value * value;
+
+        if (++c->acc_n >= c->win_n) {                      // Window complete, latch the sums and start a new one
+            c->lat_sum = c->acc_sum;
+            c->lat_sq  = c->acc_sq;
+            if (c->win_count < 0xFF) c->win_count++;
+            c->acc_sum = 0;
+            c->acc_sq  = 0;
+            c->acc_n   = 0;
+        }
+    }
+    else if (c->acc_n < 0xFFFF) {                          // Accumulate until the sensor takes the values
+        c->acc_sum += value;
+        c->acc_n++;
+    }
+
+    if (++cur_ch >= n_channels) cur_ch = 0;                // Next channel (round-robin)
+    select_channel(cur_ch);                                // The multiplexer is ready before the next trigger
+
+    TIFR1 = _BV(OCF1B);                                    // Clear the trigger flag, otherwise there is no new conversion
+#endif
+}
+
+void ADC_Engine::update_ring_every(uint8_t ch) {
+    // Exact conversions per ring sample (rounded): ms * (ADC_ENG_SAMPLE_HZ / n_channels) / 1000
+    uint32_t every = ((uint32_t)channels[ch].ring_ms * ADC_ENG_SAMPLE_HZ + 500UL * n_channels) / (1000UL * n_channels);
+
+    uint8_t sreg = SREG;
+    cli();
+    channels[ch].ring_every = constrain(every, 1, 0xFFFF);
+    channels[ch].ring_skip  = 0;
+    SREG = sreg;
+}
+
+void ADC_Engine::select_channel(uint8_t ch) {
+#if defined(__AVR__)
+    uint8_t pin = channels[ch].pin;
+    if (pin >= A0) pin -= A0;                              // Allow for channel or pin numbers
+
+#if defined(MUX5)
+    ADCSRB = (ADCSRB & ~_BV(MUX5)) | (((pin >> 3) & 0x01) << MUX5);
+#endif
+    ADMUX = _BV(REFS0) | (pin & 0x07);                     // AVcc reference (DEFAULT)
+#endif
+}
+
+#if defined(__AVR__)
+ISR(ADC_vect) {
+    adc_engine.isr_handler();
+}
+#endif
@@ -0,0 +1,102 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Buffered_Client class used to coalesce the small writes sent to a network client.
+ * It wraps any Client (Ethernet or GPRS modem) and gathers the print() output in a
+ * buffer supplied by the caller, which is sent with a single write when it is full or
+ * when flush() is called. Each chunk becomes one SPI burst / TCP segment (or one AT
+ * send command) instead of one per print() call. The reads are not buffered
+ *
+ */
+
+#include "Buffered_Client.h"
+
+extern bool DEBUG;
+
+
+Buffered_Client::Buffered_Client(Client &_client, uint8_t *_buff, size_t _size) : client(_client) {
+    buff = _buff;
+    size = _size;
+    len  = 0;
+}
+
+int Buffered_Client::connect(IPAddress ip, uint16_t port) {
+    len = 0;                                               // The output of a previous connection is discarded
+    return client.connect(ip, port);
+}
+
+int Buffered_Client::connect(const char *host, uint16_t port) {
+    len = 0;
+    return client.connect(host, port);
+}
+
+size_t Buffered_Client::write(uint8_t c) {
+    if (len >= size) flush();
+    if (getWriteError()) return 0;                         // Connection lost, the output is discarded
+
+    buff[len++] = c;
+
+    return 1;
+}
+
+size_t Buffered_Client::write(const uint8_t *buffer, size_t n) {
+    size_t n_written = 0;
+
+    while (n > 0) {
+        if (len >= size) flush();
+        if (getWriteError()) break;
+
+        size_t n_copy = min(n, size - len);
+        memcpy(buff + len, buffer, n_copy);
+        len += n_copy;
+        buffer += n_copy;
+        n -= n_copy;
+        n_written += n_copy;
+    }
+
+    return n_written;
+}
+
+int Buffered_Client::available() {
+    return client.available();
+}
+
+int Buffered_Client::read() {
+    return client.read();
+}
+
+int Buffered_Client::read(uint8_t *buf, size_t n) {
+    return client.read(buf, n);
+}
+
+int Buffered_Client::peek() {
+    return client.peek();
+}
+
+void Buffered_Client::flush() {
+    if (len == 0) return;
+
+    size_t n_sent = client.write(buff, len);
+
+    if (n_sent < len) {                                    // Connection lost
+        setWriteError();
+        DEBUG_NL(F("[!] Network write error"))
+    }
+
+    len = 0;
+}
+
+void Buffered_Client::stop() {
+    flush();
+    client.stop();
+}
+
+uint8_t Buffered_Client::connected() {
+    return client.connected();
+}
+
+Buffered_Client::operator bool() {
+    return (bool)client;
+}
@@ -0,0 +1,119 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * CBOR_Writer class used to encode compact binary messages (RFC 7049) without dynamic memory.
+ * Only the items needed by the telemetry are supported: integers, text strings, arrays
+ * (definite and indefinite length) and maps. The items that do not fit in the buffer
+ * supplied by the caller are discarded (marking the overflow)
+ *
+ */
+
+#include "CBOR_Writer.h"
+
+// Major types
+#define CBOR_UINT                  0
+#define CBOR_NEGINT                1
+#define CBOR_TEXT                  3
+#define CBOR_ARRAY                 4
+#define CBOR_MAP                   5
+
+#define CBOR_INDEF                 31                      // Additional info of the indefinite length items
+#define CBOR_BREAK                 0xFF                    // End of an indefinite length item
+#define CBOR_NULL                  0xF6                    // Simple value null (major type 7)
+
+
+CBOR_Writer::CBOR_Writer(uint8_t *_buff, size_t _size) {
+    buff = _buff;
+    size = _size;
+    reset();
+}
+
+void CBOR_Writer::reset() {
+    len = 0;
+    overflow = false;
+}
+
+void CBOR_Writer::put_uint(uint32_t value) {
+    put_head(CBOR_UINT, value);
+}
+
+void CBOR_Writer::put_int(int32_t value) {
+    if (value >= 0)
+        put_head(CBOR_UINT, value);
+    else
+        put_head(CBOR_NEGINT, (uint32_t)(-1 - value));     // Negative values are encoded as -1 - n
+}
+
+void CBOR_Writer::put_text(const char *str) {
+    size_t str_len = strlen(str);
+
+    put_head(CBOR_TEXT, str_len);
+    while (*str) put_byte(*str++);
+}
+
+void CBOR_Writer::put_null() {
+    put_byte(CBOR_NULL);
+}
+
+void CBOR_Writer::begin_array(uint16_t n_items) {
+    put_head(CBOR_ARRAY, n_items);
+}
+
+void CBOR_Writer::begin_indef_array() {
+    put_byte((CBOR_ARRAY << 5) | CBOR_INDEF);
+}
+
+void CBOR_Writer::end_indef() {
+    put_byte(CBOR_BREAK);
+}
+
+void CBOR_Writer::begin_map(uint16_t n_pairs) {
+    put_head(CBOR_MAP, n_pairs);
+}
+
+const uint8_t *CBOR_Writer::data() const {
+    return buff;
+}
+
+const size_t CBOR_Writer::length() const {
+    return len;
+}
+
+bool CBOR_Writer::is_overflow() const {
+    return overflow;
+}
+
+void CBOR_Writer::put_head(uint8_t major, uint32_t value) {
+    major <<= 5;
+
+    if (value < 24) {                                      // The value fits in the initial byte
+        put_byte(major | value);
+    }
+    else if (value <= 0xFF) {
+        put_byte(major | 24);
+        put_byte(value);
+    }
+    else if (value <= 0xFFFF) {
+        put_byte(major | 25);
+        put_byte(value >> 8);
+        put_byte(value);
+    }
+    else {
+        put_byte(major | 26);
+        put_byte(value >> 24);
+        put_byte(value >> 16);
+        put_byte(value >> 8);
+        put_byte(value);
+    }
+}
+
+void CBOR_Writer::put_byte(uint8_t b) {
+    if (len >= size) {
+        overflow = true;
+        return;
+    }
+
+    buff[len++] = b;
+}
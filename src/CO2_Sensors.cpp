@@ -0,0 +1,67 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ * 
+ * CO2_Sensors class used to control all analog CO2 sensors attached to the system
+ * 
+ */
+
+#include "CO2_Sensors.h"
+
+
+CO2_Sensors::CO2_Sensors() {
+	n_sensors = 0;
+    
+    for (uint8_t i=0; i<CO2_MAX_NUM_SENSORS; i++)
+        arr_results[i] = 0;
+};
+
+bool CO2_Sensors::add_sensor(uint8_t pin) {
+    if (n_sensors >= CO2_MAX_NUM_SENSORS) return false;
+
+    int8_t ch = adc_engine.add_channel(pin);               // The pin is sampled in background by the ADC engine
+    if (ch < 0) return false;
+    adc_engine.set_ring_interval(ch, CO2_SENS_MS_INTERV);  // The filter spans CO2_SENS_N_SAMP_READ * CO2_SENS_MS_INTERV
+
+    adc_ch[n_sensors++] = ch;
+    return true;
+}
+
+void CO2_Sensors::capture_all_sensors() {
+	for (uint8_t i=0; i<n_sensors; i++)
+        arr_results[i] = get_sensor_value(i);
+}
+
+const float CO2_Sensors::get_sensor_value(uint8_t n_sensor) {
+    if (n_sensor >= n_sensors) return 0;                   // If n_sensor is out of bounds for number of sensors attached, return 0
+
+    // Mean of the latest samples, discarding lower and higher value
+    float read_v = adc_engine.get_trimmed_mean(adc_ch[n_sensor], CO2_SENS_N_SAMP_READ);
+    read_v = read_v * 5 / 1024;                            // Convert adc scale to voltage
+
+    return read_v + 1420;                                  // Apply sensor offset
+}
+
+const uint8_t CO2_Sensors::get_n_sensors() {
+    return n_sensors;
+}
+
+bool CO2_Sensors::poll_capture() {
+    capture_all_sensors();
+    return true;
+}
+
+const uint8_t CO2_Sensors::get_n_channels() {
+    return n_sensors;
+}
+
+Channel_type_t CO2_Sensors::get_channel_type(uint8_t ch) {
+    return ct_CO2;
+}
+
+const float CO2_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= n_sensors) return 0;
+
+    return arr_results[ch];
+}
@@ -45,8 +45,10 @@
 //======================= Net options =======================
 //===========================================================
 #define ETH_SS_PIN                 10
+#define ETH_N_SOCKETS              4                       // Hardware sockets of the Ethernet chip (W5100 = 4)
 const uint8_t ETH_MAC[] = {0xDE,0xAD,0xBE,0xEF,0xFE,0xED}; // MAC address for the ethernet controller
 const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
+#define NET_TX_BUFF_SIZE           512                     // Coalescing buffer of the HTTP output (max. TCP segment sent, MSS 1460 on W5100)
 
 #define TINY_GSM_MODEM_A6                                  // Select the GPRS modem
 #define TINY_GSM_RX_BUFFER         512                     // Increase the buffer
@@ -57,6 +59,19 @@ const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
 #define GPRS_USER                  ""                      //
 #define GPRS_PASS                  ""                      //
 
+#define MODEM_POWER_UP_MS          3000                    // Time for the modem to boot before the first AT command
+#define MODEM_AT_TIMEOUT_MS        1000                    // Maximum wait for the answer of each AT command
+#define MODEM_INIT_TIMEOUT_MS      10000                   // Maximum time for the modem to answer after the power up
+#define MODEM_NET_TIMEOUT_MS       60000                   // Maximum wait for the network registration
+#define MODEM_NET_POLL_MS          1000                    // Interval between the checks of the network, attach & PDP context
+#define MODEM_GPRS_TIMEOUT_MS      60000                   // Maximum wait for the GPRS attach and for the PDP context activation
+#define MODEM_HEALTH_CHECK_MS      30000                   // Interval between the checks of the GPRS session
+#define MODEM_BACKOFF_MIN_S        5                       // Wait after the first failed attempt (doubled on each new failure)
+#define MODEM_BACKOFF_MAX_S        300                     // Maximum wait between attempts
+#define MODEM_RESTART_AFTER_FAILS  3                       // Consecutive failures before restarting the modem instead of init
+#define MODEM_MQTT_MUX             1                       // Modem connection (mux) used by the MQTT broker client
+#define MODEM_MQTT_CONNECT_S       8                       // Maximum wait (in seconds) for the TCP connection with the broker (GPRS)
+
 
 //===========================================================
 //======================= MQTT broker =======================
@@ -67,6 +82,20 @@ const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
 #define MQTT_BROKER_USR            ""                      // MQTT broker user & password identification
 #define MQTT_BROKER_PSW            ""                      //
 #define INFLUXDB_MEASUREMENT       "sensors"               // Indicates the measurements to store data
+#define MQTT_DEF_BATCH_SIZE        1                       // Samples published in each message by default (1 = no batching)
+#define MQTT_MAX_BATCH_SIZE        20                      // Maximum samples of a batch
+#define MQTT_PREFIX_MAX_LEN        80                      // Max. length of the measurement+tags prefix of the line protocol
+const Payload_enc_t MQTT_DEF_ENCODING = pe_text;           // Encoding of the payload by default (text | CBOR | CBOR with deltas)
+#define MQTT_CBOR_KEYFRAME_EVERY   10                      // With deltas, absolute values are sent every N messages
+#define MQTT_BACKOFF_MIN_MS        2000                    // Wait after the first failed reconnection (doubled on each new failure)
+#define MQTT_BACKOFF_MAX_MS        300000                  // Maximum wait between reconnection attempts
+#define MQTT_SOCKET_TIMEOUT_S      5                       // Maximum wait (in seconds) for the broker answers
+#define MQTT_CONNECT_TIMEOUT_MS    3000                    // Maximum wait for the TCP connection with the broker (Ethernet)
+#define MQTT_ACT_TOPIC_LEN         48                      // Max. length of the actuators topics (<host_id>/actuators/<dev_id>/state)
+
+#define MQTT_SAMPLE_REJECTED       -1                      // The sample could not be published or stored in the batch
+#define MQTT_SAMPLE_BUFFERED       0                       // The sample waits in the batch
+#define MQTT_SAMPLE_SENT           1                       // The batch with the sample has been published
 
 
 //===========================================================
@@ -99,6 +128,18 @@ const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
 #define SD_MAX_FILENAME_SIZE       14                      // Defines de max size of filename
 #define SD_INI_CFG_FILENAME        "/config.ini"           // Filename of config ini file
 #define SD_DATA_DELIMITED          '#'                     // Char delimiter for tags & data bulks in SD
+#define SD_LOG_DEF_KEEP_OPEN       1                       // Indicates whether the log file is kept open (buffered writes) by default
+#define SD_LOG_DEF_FLUSH_SECS      60                      // Maximum time (in seconds) the records stay in memory (max. data lost on power failure)
+#define SD_LOG_SECTOR_SIZE         512                     // Size of the SD sectors (write buffer)
+#define SD_LOG_INDEX_FILENAME      "/logidx.txt"           // File with the index of the last log file used
+#define SD_LOG_MAX_FILE_INDEX      999999                  // Maximum index of the log files (6 digits name)
+#define SD_LOG_DEF_MAX_FILE_KB     1024                    // Size (in KB) at which the log file is rotated by default (0 = no limit)
+#define SD_LOG_DEF_DAILY_ROTATE    1                       // Indicates whether a new log file is started every day by default (needs RTC)
+#define SD_QUEUE_DEF_ENABLED       1                       // Indicates whether the records not published are queued on SD by default
+#define SD_QUEUE_FILENAME          "/queue.txt"            // File with the records pending to publish
+#define SD_QUEUE_CURSOR_FILENAME   "/queue.pos"            // File with the offset of the first pending record
+#define SD_QUEUE_DEF_MAX_KB        512                     // Maximum size (in KB) of the queue file by default
+#define SD_QUEUE_DEF_BATCH         4                       // Maximum queued records published per cycle by default
 
 #define INI_FILE_BUFFER_LEN        80                      // Indicates the size of the buffer to get values from the start file
 
@@ -106,7 +147,33 @@ const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
 //===========================================================
 //=========================== etc ===========================
 //===========================================================
-#define DELAY_SECS_NEXT_READ       30                      // Timer (in seconds) of waiting between readings of the sensors
+#define DELAY_SECS_NEXT_READ       30                      // Default sampling period (in seconds) of the sensors groups
+#define RECORD_BUFF_SIZE           256                     // Size of the buffer where the sensors records are composed
+
+
+//===========================================================
+//======================== Scheduler ========================
+//===========================================================
+#define SCHED_MAX_TASKS            10                      // Maximum number of acquisition tasks
+#define SCHED_DEF_TASK_TIMEOUT     20000                   // Default deadline (in ms) for a task since the cycle started
+#define SCHED_MIN_PERIOD_S         1                       // Minimum sampling period (in seconds) of a sensors group
+
+
+//===========================================================
+//===================== Sensor registry =====================
+//===========================================================
+#define REG_MAX_SENSORS            SCHED_MAX_TASKS         // Maximum number of sensor objects registered
+#define REG_MAX_CHANNELS           32                      // Maximum number of channels (values) of all the sensors
+#define REG_LCD_MAX_VALUES         4                       // Maximum number of channels shown on the LCD
+
+
+//===========================================================
+//======================= ADC engine ========================
+//===========================================================
+#define ADC_ENG_MAX_CHANNELS       8                       // Maximum number of analog channels sampled in background
+#define ADC_ENG_RING_SIZE          16                      // Number of latest samples stored for each channel
+#define ADC_ENG_SAMPLE_HZ          4000                    // Total conversions per second, shared by all channels (Timer1)
+#define ADC_ENG_MAX_WINDOW         4000                    // Maximum samples of a metering window (sum of squares fits in 32 bits)
 
 
 //===========================================================
@@ -116,6 +183,7 @@ const Internet_cnn_type NET_DEF_CNN_TYPE = it_none;
 const uint8_t DHT_DEF_SENSORS[] =  {OPENSPIR_VGA_PIN4};    // Array for default pin for DHT sensors
 #define DHT_DEF_TYPE               DHT22                   // Default DHT sensors type
 #define DHT_MAX_SENSORS            5                       // Maximum number of sensors that will be allowed
+#define DHT_DEF_PERIOD_S           DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 
 //===========================================================
@@ -125,6 +193,7 @@ const uint8_t DHT_DEF_SENSORS[] =  {OPENSPIR_VGA_PIN4};    // Array for default
 #define LUX_SENS_ADDR              0x5C                    // Pin ADDR for apply HIGH level (5v) to assign 0x5C address
 #define LUX_SENS_ADDR_PIN          OPENSPIR_VGA_PIN7       // Pin ADDR for apply HIGH level (5v) to assign 0x5C address
 #define LUX_SENS_N_SAMP_READ       10                      // Number of samples read from sensor
+#define LUX_SENS_DEF_PERIOD_S      DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 #define LUX_SENS_DEF_NUM          2                        // Number of current sensors by default
 const uint8_t LUX_SENS_DEF_MODELS[]   = {1, 2};            // Available models: 1=BH1750, 2=MAX44009
@@ -142,6 +211,8 @@ const uint8_t LUX_SENS_DEF_ADDR_PIN[] = {34, 0};
 #define DO_SENS_B_LED_PIN          OPENSPIR_VGA_PIN2       // Pin for DO Blue LED
 #define DO_SENS_N_SAMP_READ        10                      // Number of samples read from sensor
 #define DO_SENS_MS_READS           150                     // Time (in ms) between each reading
+#define DO_SENS_MS_LED_SETTLE      500                     // Time (in ms) to wait for the LEDs to settle before reading
+#define DO_SENS_DEF_PERIOD_S       DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 
 //===========================================================
@@ -151,8 +222,10 @@ const uint8_t LUX_SENS_DEF_ADDR_PIN[] = {34, 0};
 #define PH_DEF_NUM_SENSORS         1                       // Number of sensors actived by default
 const uint8_t PH_DEF_PIN_SENSORS[] = {OPENSPIR_SHIELD_J1}; // Array for default pins for pH sensors
 #define PH_MAX_NUM_SENSORS         3                       // Maximum number of pH sensors that can be connected
-#define PH_SENS_N_SAMP_READ        10                      // Number of samples read from sensor
+#define PH_SENS_N_SAMP_READ        10                      // Number of samples read from sensor (max. ADC_ENG_RING_SIZE)
+#define PH_SENS_MS_INTERV          10                      // Time (in ms) between each sample of the filter
 #define PH_MS_INTERVAL             1000                    // Time (in ms) between pH readings
+#define PH_DEF_PERIOD_S            DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 
 //===========================================================
@@ -160,6 +233,8 @@ const uint8_t PH_DEF_PIN_SENSORS[] = {OPENSPIR_SHIELD_J1}; // Array for default
 //===========================================================
 #define WP_T_ONE_WIRE_PIN          OPENSPIR_VGA_PIN14      // Where 1-Wire is connected
 #define WP_T_MAX_PAIRS_SENS        4
+#define WP_T_DEF_RESOLUTION        12                      // Default resolution (9-12 bits). Conversion time: 94, 188, 375 or 750 ms
+#define WP_T_DEF_PERIOD_S          DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 #define WP_T_DEF_NUM_PAIRS         2                       // Define the number of sensor pairs by default
 const uint8_t WP_T_DEF_SENST_PAIRS[][2][8] = {             // Define the pairs
@@ -178,9 +253,16 @@ const uint8_t WP_T_DEF_SENST_PAIRS[][2][8] = {             // Define the pairs
 //====================== Current sensor =====================
 //===========================================================
 #define CURR_MAX_NUM_SENSORS       6                       // Maximum number of current sensors that can be connected
-#define CURR_SENS_N_SAMPLES        100                     // Number of samples to read to make the average (value between 1-255)
-#define CURR_SENS_MS_INTERV        1                       // Milliseconds to wait between the read intervals
 #define CURR_SENS_MS_BE            30L * 1000L             // Time in seconds between current ini current end measure
+#define CURR_SENS_DEF_PERIOD_S     DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
+#define CURR_METER_DEF_ENABLED     0                       // Indicates whether the true-RMS metering mode is enabled by default
+#define CURR_METER_DEF_MAINS_HZ    50                      // Mains frequency (in Hz)
+#define CURR_METER_DEF_VOLTAGE     230                     // Nominal mains voltage (in V) used to calculate the energy
+#define CURR_METER_N_CYCLES        10                      // Number of whole mains cycles of each metering window
+#define CURR_METER_SAVE_SECS       900                     // Time (in seconds) between each save of the energy counters to EEPROM
+#define CURR_METER_EEPROM_ADDR     0                       // EEPROM address of the ring of slots where the energy counters are stored
+#define CURR_METER_EEPROM_SLOTS    32                      // Slots of the ring. Each save uses the next one to spread the EEPROM wear
+#define CURR_METER_EEPROM_MAGIC    0x4F53                  // Mark of valid energy counters in EEPROM
 
 #define CURR_SENS_DEF_NUM          2                       // Number of current sensors by default
 const uint8_t CURR_SENS_DEF_PINS[] = {OPENSPIR_SHIELD_J4,  // Array for default pins for current sensors
@@ -193,7 +275,10 @@ const uint16_t CURR_SENS_DEF_VAR[] = {20, 30};
 //======================== CO2 sensor =======================
 //===========================================================
 #define CO2_DEF_NUM_SENSORS        0
-#define CO2_SENS_N_SAMP_READ       15                      // Number of samples read from sensor
+#define CO2_MAX_NUM_SENSORS        2                       // Maximum number of CO2 sensors that can be connected
+#define CO2_SENS_N_SAMP_READ       15                      // Number of samples read from sensor (max. ADC_ENG_RING_SIZE)
+#define CO2_SENS_MS_INTERV         100                     // Time (in ms) between each sample of the filter
+#define CO2_SENS_DEF_PERIOD_S      DELAY_SECS_NEXT_READ    // Sampling period (in seconds)
 const uint8_t CO2_SENS_DEF_PINS[] = {};                    // CO2 pin (Analog)
 
 
@@ -203,6 +288,8 @@ const uint8_t CO2_SENS_DEF_PINS[] = {};                    // CO2 pin (Analog)
 #define ORP_DEF_NUM_SENSORS        1                       // Number of sensors actived by default
 const uint8_t ORP_DEF_ADDRS[] =    {0x62};                 // Array for default pin for ORP sensors
 #define ORP_MAX_SENSORS            5                       // Maximum number of sensors that will be allowed
+#define ORP_MS_READ_TIME           900                     // Time (in ms) the probe needs to complete a read command
+#define ORP_DEF_PERIOD_S           DELAY_SECS_NEXT_READ    // Default sampling period (in seconds)
 
 
 //===========================================================
@@ -211,6 +298,18 @@ const uint8_t ORP_DEF_ADDRS[] =    {0x62};                 // Array for default
 #define ACT_WEB_SRV_DEF_PORT       8080                    // Default Web Server port to listen actions petition
 #define ACT_WEBSRV_ACTIONS_STR     F("/action?")           // VDir petition triger for actions on HTTP requests
 #define ACT_WEBSRV_STATUS_STR      F("/status")            // VDir petition triger for status on HTTP requests
+#define ACT_WEBSRV_API_STATUS_STR  F("/api/status")        // VDir of the status page data (JSON) on HTTP requests
+#define ACT_WEBSRV_READINGS_STR    F("/api/readings")      // VDir of the latest readings (JSON) on HTTP requests
+#define ACT_WEBSRV_MAX_METHOD_LEN  7                       // HTTP method max. length (400 if longer)
+#define ACT_WEBSRV_MAX_TARGET_LEN  64                      // Request path + query max. length (414 if longer)
+#define ACT_WEBSRV_MAX_HEADER_LEN  256                     // Header line max. length (400 if longer)
+#define ACT_WEBSRV_MAX_HEADERS     32                      // Maximum number of header lines (400 if more)
+#define ACT_WEBSRV_HDR_VALUE_LEN   32                      // Stored length of the known headers values (the rest is ignored)
+#define ACT_WEBSRV_TIMEOUT_MS      2000                    // Maximum time (in ms) to receive a whole request, since its first byte
+#define ACT_WEBSRV_IDLE_MS         5000                    // Time (in ms) waiting for a request before closing the connection (keep-alive)
+#define ACT_WEBSRV_MAX_CLIENTS     2                       // Max. clients attended at the same time (limited by the free ETH_N_SOCKETS)
+#define ACT_WEBSRV_MAX_READ        64                      // Maximum bytes parsed per client and call, so the loop is never blocked
+#define ACT_WEBSRV_BOOT_EE_ADDR    4094                    // EEPROM address of the boot counter (ETags of /api/readings)
 #define ACT_MAX_NUM_DEVICES        5                       // Maximum number of actuators that will be allowed
 #define ACT_MAX_DEV_ID_LEN         12                      // Actuator device ID max lenght
 
@@ -13,16 +13,39 @@
  */
 
 #include "Current_Sensors.h"
+#include <EEPROM.h>
+
+extern bool DEBUG;
 
 
 Current_Sensors::Current_Sensors() {
     v_ref = read_V_ref();
     n_sensors = 0;
+
+    metering = false;
+    win_ready = false;
+    mains_hz = CURR_METER_DEF_MAINS_HZ;
+    voltage = CURR_METER_DEF_VOLTAGE;
+    win_secs = 0;
+    last_save_ms = 0;
+    energy.magic = CURR_METER_EEPROM_MAGIC;
+    energy.seq = 0;
+    ee_slot = CURR_METER_EEPROM_SLOTS - 1;                 // The first save goes to the slot 0
+
+    for (uint8_t i=0; i<CURR_MAX_NUM_SENSORS; i++) {
+        arr_current[i] = 0;
+        energy.mWh[i] = 0;
+        energy_frac[i] = 0;
+    }
 }
 
 bool Current_Sensors::add_sensor(uint8_t pin, Current_Model_t model, const uint16_t var) {
     if (n_sensors >= CURR_MAX_NUM_SENSORS) return false;
 
+    int8_t ch = adc_engine.add_channel(pin);               // The pin is sampled in background by the ADC engine
+    if (ch < 0) return false;
+
+    sensors[n_sensors].adc_ch = ch;
     sensors[n_sensors].model = model;
     sensors[n_sensors].pin = pin;
     sensors[n_sensors].var = var;
@@ -47,6 +70,11 @@ const float Current_Sensors::get_current_value(uint8_t n_sensor) {
 }
 
 void Current_Sensors::capture_all_sensors() {
+    if (metering) {                                        // Irms is updated by the metering windows
+        poll_metering();
+        return;
+    }
+
     for (uint8_t i=0; i<n_sensors; i++) {
         arr_current[i] = get_current_value(i);
     }
@@ -54,13 +82,10 @@ void Current_Sensors::capture_all_sensors() {
 
 /* Obtain current value on specific invasive sensor ACS712 */
 const float Current_Sensors::get_current_ACS712(uint8_t n_sensor) {
-    float sens_val = 0;
+    float sens_val;
 
-    for (uint8_t i=0; i<CURR_SENS_N_SAMPLES; i++) {
-        sens_val += (float) analogRead(sensors[n_sensor].pin);
-        delay(CURR_SENS_MS_INTERV);
-    }
-    sens_val = (sens_val / CURR_SENS_N_SAMPLES) * (5.0 / 1023.0);
+    if (!take_mean_sample(n_sensor, sens_val)) return arr_current[n_sensor];
+    sens_val *= (5.0 / 1023.0);
 
     float ac_offset = v_ref / 2000.0;
     float sensitivity = (sensors[n_sensor].var / 1000.0) * (v_ref / 5000.0);
@@ -70,14 +95,9 @@ const float Current_Sensors::get_current_ACS712(uint8_t n_sensor) {
 
 /* Obtain current value on specific non-invasive sensor SCT013 */
 const float Current_Sensors::get_current_SCT013(uint8_t n_sensor) {
-    unsigned int peakVoltage = 0;
-
-    for (uint8_t i=0; i<CURR_SENS_N_SAMPLES; i++) {
-        peakVoltage += analogRead(sensors[n_sensor].pin);  // Read peak voltage
-        delay(CURR_SENS_MS_INTERV);
-    }
+    float peakVoltage;
 
-    peakVoltage /= CURR_SENS_N_SAMPLES;
+    if (!take_mean_sample(n_sensor, peakVoltage)) return arr_current[n_sensor];  // Read peak voltage
 
     float v_rms = peakVoltage * 0.707;                     // Change the peak voltage to the Virtual Value of voltage
     v_rms = (v_rms * v_ref / 1024.0) / 2.0;                // The circuit is amplified by 2 times, so it is divided by 2
@@ -85,6 +105,135 @@ const float Current_Sensors::get_current_SCT013(uint8_t n_sensor) {
     return (v_rms * sensors[n_sensor].var) / 1000;
 }
 
+bool Current_Sensors::take_mean_sample(uint8_t n_sensor, float &mean_v) {
+    uint32_t sum;
+    uint16_t n = adc_engine.take_accum(sensors[n_sensor].adc_ch, sum);
+
+    if (n == 0) return false;                              // No samples since the last capture
+
+    mean_v = (float)sum / n;
+    return true;
+}
+
+void Current_Sensors::set_metering(bool enabled, uint8_t _mains_hz, uint16_t _voltage) {
+    metering = enabled;
+    mains_hz = _mains_hz? _mains_hz : CURR_METER_DEF_MAINS_HZ;
+    voltage = _voltage;
+    win_ready = false;
+
+    if (!metering) return;
+
+    load_energy();                                         // Restore the energy counters saved before the reboot
+}
+
+bool Current_Sensors::is_metering() {
+    return metering;
+}
+
+void Current_Sensors::poll_metering() {
+    if (!metering || !adc_engine.is_running()) return;
+
+    if (!win_ready) {                                      // Windows of whole mains cycles at the channel rate
+        // From the exact engine rate (the channel rate is truncated), rounded to the nearest sample
+        uint32_t conv_hz = (uint32_t)mains_hz * adc_engine.get_n_channels();
+        uint16_t win_n = ((uint32_t)ADC_ENG_SAMPLE_HZ * CURR_METER_N_CYCLES + conv_hz / 2) / conv_hz;
+
+        for (uint8_t i=0; i<n_sensors; i++)
+            adc_engine.set_window(sensors[i].adc_ch, win_n);
+
+        win_secs = (float)win_n * adc_engine.get_n_channels() / ADC_ENG_SAMPLE_HZ;
+        last_save_ms = millis();
+        win_ready = true;
+
+        DEBUG_V2(F("[Curr] Metering window (samples): "), win_n)
+        return;
+    }
+
+    uint32_t sum, sum_sq;
+    uint16_t n;
+    uint8_t windows;
+    float mean_v, var_v, whole;
+
+    for (uint8_t i=0; i<n_sensors; i++) {
+        windows = adc_engine.take_window(sensors[i].adc_ch, sum, sum_sq, n);
+        if (windows == 0) continue;
+
+        mean_v = (float)sum / n;                           // DC offset of the signal
+        var_v = (float)sum_sq / n - mean_v * mean_v;       // Mean of squares without the offset
+        arr_current[i] = rms_to_current(i, (var_v > 0)? sqrt(var_v) : 0);
+
+        // Energy of the completed windows (W*s / 3.6 = mWh). Windows missed by the loop take the last Irms
+        energy_frac[i] += voltage * arr_current[i] * win_secs * windows / 3.6;
+        whole = floor(energy_frac[i]);
+        energy.mWh[i] += (uint32_t)whole;
+        energy_frac[i] -= whole;
+    }
+
+    if (millis() - last_save_ms >= CURR_METER_SAVE_SECS * 1000UL)
+        save_energy();
+}
+
+const float Current_Sensors::get_energy_Wh(uint8_t n_sensor) {
+    if (n_sensor >= n_sensors) return 0;
+
+    return (energy.mWh[n_sensor] + energy_frac[n_sensor]) / 1000.0;
+}
+
+void Current_Sensors::save_energy() {
+    if (!metering) return;
+
+    ee_slot = (ee_slot + 1) % CURR_METER_EEPROM_SLOTS;     // Each slot is written once every CURR_METER_EEPROM_SLOTS saves
+    energy.seq++;
+    energy.check = energy_check(energy);
+
+    EEPROM.put(CURR_METER_EEPROM_ADDR + ee_slot * sizeof(Curr_energy_t), energy);   // Only the changed bytes are written
+    last_save_ms = millis();
+}
+
+void Current_Sensors::load_energy() {
+    Curr_energy_t stored;
+    bool found = false;
+
+    for (uint8_t i=0; i<CURR_METER_EEPROM_SLOTS; i++) {
+        EEPROM.get(CURR_METER_EEPROM_ADDR + i * sizeof(Curr_energy_t), stored);
+        if (stored.magic != CURR_METER_EEPROM_MAGIC || stored.check != energy_check(stored))
+            continue;                                      // Empty slot or interrupted save
+
+        if (!found || (int16_t)(stored.seq - energy.seq) > 0) {   // The sequence may wrap around
+            memcpy(&energy, &stored, sizeof(Curr_energy_t));
+            ee_slot = i;
+            found = true;
+        }
+    }
+
+    DEBUG_V2(F("[Curr] Energy counters restored from slot: "), found? ee_slot : -1)
+}
+
+uint8_t Current_Sensors::energy_check(const Curr_energy_t &e) {
+    const uint8_t *p = (const uint8_t *)&e;
+    uint8_t check = 0;
+
+    for (uint8_t i=0; i<offsetof(Curr_energy_t, check); i++)
+        check ^= p[i];
+
+    return check;
+}
+
+const float Current_Sensors::rms_to_current(uint8_t n_sensor, float rms_v) {
+    switch (sensors[n_sensor].model) {
+        case ACS712: {
+            float sensitivity = (sensors[n_sensor].var / 1000.0) * (v_ref / 5000.0);
+            return (rms_v * (5.0 / 1023.0)) / sensitivity;
+        }
+        case SCT013: {
+            float v_rms = (rms_v * v_ref / 1024.0) / 2.0;  // The circuit is amplified by 2 times, so it is divided by 2
+            return (v_rms * sensors[n_sensor].var) / 1000;
+        }
+    }
+
+    return 0;
+}
+
 const uint8_t Current_Sensors::get_n_sensors() {
     return n_sensors;
 }
@@ -126,18 +275,25 @@ uint16_t Current_Sensors::read_V_ref() {
 #endif
 }
 
-void Current_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
-    
-    for (uint8_t i=0; i<n_sensors; i++) {
-        if (i && delim != '\0') str.concat(delim);
-        if (print_tag) {
-            str.concat(F("I"));
-            str += i+1;
-            
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(arr_current[i]);
-    }
+bool Current_Sensors::poll_capture() {
+    capture_all_sensors();
+    return true;
+}
+
+const uint8_t Current_Sensors::get_n_channels() {
+    return metering? n_sensors * 2 : n_sensors;
+}
+
+Channel_type_t Current_Sensors::get_channel_type(uint8_t ch) {
+    return (ch < n_sensors)? ct_Current : ct_Energy;
+}
+
+uint8_t Current_Sensors::get_channel_num(uint8_t ch) {
+    return (ch < n_sensors)? ch + 1 : ch - n_sensors + 1;
+}
+
+const float Current_Sensors::get_channel_value(uint8_t ch) {
+    if (ch < n_sensors) return arr_current[ch];
+
+    return get_energy_Wh(ch - n_sensors);
 }
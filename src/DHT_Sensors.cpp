@@ -55,30 +55,25 @@ const uint8_t DHT_Sensors::get_n_sensors() {
     return n_sensors;
 }
 
-void DHT_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
+bool DHT_Sensors::poll_capture() {
+    capture_all_sensors();
+    return true;
+}
 
-    for (uint8_t i=0; i<n_sensors; i++) {
-        if (i && delim != '\0') str.concat(delim);
+const uint8_t DHT_Sensors::get_n_channels() {
+    return n_sensors * 2;
+}
 
-        if (print_tag) {                                   // Ambient temperature
-            str.concat(F("Amb"));
-            str += i+1;
-            str.concat(F("_t"));
+Channel_type_t DHT_Sensors::get_channel_type(uint8_t ch) {
+    return (ch % 2)? ct_Amb_hum : ct_Amb_temp;
+}
 
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(arr_Temp[i]);
+uint8_t DHT_Sensors::get_channel_num(uint8_t ch) {
+    return ch / 2 + 1;
+}
 
-        str.concat(delim);
-        if (print_tag) {                                   // Ambient humidity
-            str.concat(F("Amb"));
-            str += i+1;
-            str.concat(F("_h"));
+const float DHT_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= n_sensors * 2) return 0;
 
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(arr_Humd[i]);
-    }
+    return (ch % 2)? arr_Humd[ch / 2] : arr_Temp[ch / 2];
 }
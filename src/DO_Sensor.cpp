@@ -16,6 +16,7 @@ DO_Sensor::DO_Sensor() {
     ms_reads     = DO_SENS_MS_READS;
     lux_results  = {0, };
     initialized  = false;
+    scan.phase   = ph_Done;
 }
 
 bool DO_Sensor::begin(uint8_t _addr, uint8_t _R_pin, uint8_t _G_pin, uint8_t _B_pin) {
@@ -39,11 +40,85 @@ bool DO_Sensor::begin(uint8_t _addr, uint8_t _R_pin, uint8_t _G_pin, uint8_t _B_
 }
 
 void DO_Sensor::capture_DO() {
-    lux_results.preLux_value = capture_preLux();           // Get pre Lux value without any actived led
-    lux_results.R_value = capture_Red_LED();               // Get the values for each LED color from the DO
-    lux_results.G_value = capture_Green_LED();
-    lux_results.B_value = capture_Blue_LED();
-    lux_results.W_value = capture_White_LED();
+    if (!start_capture()) return;
+
+    while (!poll_capture());                               // Run the whole scan
+}
+
+bool DO_Sensor::start_capture() {
+    if (!initialized) return false;
+
+    begin_phase(ph_preLux);                                // Get pre Lux value without any actived led
+    return true;
+}
+
+bool DO_Sensor::poll_capture() {
+    if (scan.phase == ph_Done) return true;
+
+    if (scan.settling) {                                   // Wait for the LEDs to settle
+        if (millis() - scan.last_ms < DO_SENS_MS_LED_SETTLE) return false;
+        
+        scan.settling = false;
+        scan.last_ms = millis() - ms_reads;                // The first sample is taken right now
+    }
+
+    if (millis() - scan.last_ms < ms_reads) return false;  // Wait for the next sample
+    scan.last_ms = millis();
+
+    add_sample(bh1750_dev->readLightLevel());
+    if (scan.n_reads < n_samples) return false;
+
+    store_phase_result(scan.phase, filter_samples());      // The phase is complete
+    begin_phase((DO_Phase_t)(scan.phase + 1));             // Get the values for each LED color from the DO
+
+    return (scan.phase == ph_Done);
+}
+
+void DO_Sensor::abort_capture() {
+    set_phase_LEDs(ph_Done);                               // Switch off all the LEDs
+    scan.phase    = ph_Done;
+    scan.settling = false;
+    reset_samples();
+}
+
+bool DO_Sensor::is_capture_done() {
+    return (scan.phase == ph_Done);
+}
+
+DO_Sensor::DO_Phase_t DO_Sensor::get_phase() {
+    return scan.phase;
+}
+
+uint8_t DO_Sensor::get_progress() {
+    if (scan.phase == ph_Done || n_samples == 0) return 100;
+
+    return ((uint16_t)scan.phase * n_samples + scan.n_reads) * 100 / (ph_Done * n_samples);
+}
+
+void DO_Sensor::begin_phase(DO_Phase_t phase) {
+    set_phase_LEDs(phase);
+
+    scan.phase    = phase;
+    scan.settling = (phase != ph_preLux && phase != ph_Done);  // Without LEDs there is nothing to settle
+    scan.last_ms  = millis();
+    reset_samples();
+}
+
+void DO_Sensor::set_phase_LEDs(DO_Phase_t phase) {
+    digitalWrite(R_pin, (phase == ph_Red   || phase == ph_White)? HIGH : LOW);
+    digitalWrite(G_pin, (phase == ph_Green || phase == ph_White)? HIGH : LOW);
+    digitalWrite(B_pin, (phase == ph_Blue  || phase == ph_White)? HIGH : LOW);
+}
+
+void DO_Sensor::store_phase_result(DO_Phase_t phase, float value) {
+    switch (phase) {
+        case ph_preLux: lux_results.preLux_value = value; break;
+        case ph_Red:    lux_results.R_value = value;      break;
+        case ph_Green:  lux_results.G_value = value;      break;
+        case ph_Blue:   lux_results.B_value = value;      break;
+        case ph_White:  lux_results.W_value = value;      break;
+        default: break;
+    }
 }
 
 const float DO_Sensor::capture_preLux() {
@@ -52,7 +127,7 @@ const float DO_Sensor::capture_preLux() {
 
 const float DO_Sensor::capture_Red_LED() {
     digitalWrite(R_pin, HIGH);                             // Activate red LED
-    delay(500);
+    delay(DO_SENS_MS_LED_SETTLE);
 
     float result = capture_and_filter();
     digitalWrite(R_pin, LOW);                              // Deactivate red LED
@@ -62,7 +137,7 @@ const float DO_Sensor::capture_Red_LED() {
 
 const float DO_Sensor::capture_Green_LED() {
     digitalWrite(G_pin, HIGH);                                       // Activate green LED
-    delay(500);
+    delay(DO_SENS_MS_LED_SETTLE);
 
     float result = capture_and_filter();
     digitalWrite(G_pin, LOW);                                        // Deactivate green LED
@@ -72,7 +147,7 @@ const float DO_Sensor::capture_Green_LED() {
 
 const float DO_Sensor::capture_Blue_LED() {
     digitalWrite(B_pin, HIGH);                                       // Activate blue LED
-    delay(500);
+    delay(DO_SENS_MS_LED_SETTLE);
 
     float result = capture_and_filter();
     digitalWrite(B_pin, LOW);                                        // Deactivate blue LED
@@ -84,7 +159,7 @@ const float DO_Sensor::capture_White_LED() {
     digitalWrite(R_pin, HIGH);                                       // Activate R,G,B LEDs
     digitalWrite(G_pin, HIGH);
     digitalWrite(B_pin, HIGH);
-    delay(500);
+    delay(DO_SENS_MS_LED_SETTLE);
 
     float result = capture_and_filter();
     digitalWrite(R_pin, LOW);                                        // Deactivate R,G,B LEDs
@@ -119,20 +194,35 @@ const float DO_Sensor::get_White_value() {
 }
 
 const float DO_Sensor::capture_and_filter() {
-    float read_v, min_v=0, max_v=0, total_v=0;
+    reset_samples();
 
     for (uint8_t i=n_samples; i>0; i--) {
-        read_v = bh1750_dev->readLightLevel();
-        total_v += read_v;
-
-        if (read_v < min_v) min_v = read_v;                          // Update de min value
-        if (read_v > max_v) max_v = read_v;                          // Update de max value
-
+        add_sample(bh1750_dev->readLightLevel());
         delay(ms_reads);
     }
-    total_v = total_v - min_v - max_v;                               // Discards lower and higher value for the average
 
-    return (total_v / (n_samples-2));
+    return filter_samples();
+}
+
+void DO_Sensor::reset_samples() {
+    scan.total_v = 0;
+    scan.min_v = 0;
+    scan.max_v = 0;
+    scan.n_reads = 0;
+}
+
+void DO_Sensor::add_sample(float read_v) {
+    if (scan.n_reads == 0 || read_v < scan.min_v) scan.min_v = read_v;  // Update de min value
+    if (scan.n_reads == 0 || read_v > scan.max_v) scan.max_v = read_v;  // Update de max value
+
+    scan.total_v += read_v;
+    scan.n_reads++;
+}
+
+const float DO_Sensor::filter_samples() {
+    if (n_samples <= 2) return scan.total_v / max(n_samples, (uint8_t)1);
+
+    return (scan.total_v - scan.min_v - scan.max_v) / (n_samples-2);     // Discards lower and higher value for the average
 }
 
 void DO_Sensor::set_n_samples(const uint8_t _n_samples) {
@@ -155,41 +245,25 @@ bool DO_Sensor::is_init() {
     return initialized;
 }
 
-void DO_Sensor::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
-    
-    if (print_tag) {                                       // preLux value
-        str.concat(F("DO_pLux"));
-        if (print_value) str.concat(F("="));
-    }
-    if (print_value) str.concat(lux_results.preLux_value);
-    str.concat(delim);
+const uint8_t DO_Sensor::get_n_channels() {
+    return 5;
+}
 
-    if (print_tag) {                                       // Red value
-        str.concat(F("DO_R"));
-        if (print_value) str.concat(F("="));
-    }
-    if (print_value) str.concat(lux_results.R_value);
-    str.concat(delim);
+Channel_type_t DO_Sensor::get_channel_type(uint8_t ch) {
+    return (Channel_type_t)(ct_DO_preLux + min(ch, (uint8_t)4));
+}
 
-    if (print_tag) {                                       // Green value
-        str.concat(F("DO_G"));
-        if (print_value) str.concat(F("="));
-    }
-    if (print_value) str.concat(lux_results.G_value);
-    str.concat(delim);
+uint8_t DO_Sensor::get_channel_num(uint8_t ch) {
+    return 1;
+}
 
-    if (print_tag) {                                       // Blue value
-        str.concat(F("DO_B"));
-        if (print_value) str.concat(F("="));
-    }
-    if (print_value) str.concat(lux_results.B_value);
-    str.concat(delim);
-    
-    if (print_tag) {                                       // White (RGB) value
-        str.concat(F("DO_W"));
-        if (print_value) str.concat(F("="));
+const float DO_Sensor::get_channel_value(uint8_t ch) {
+    switch (ch) {
+        case 0: return lux_results.preLux_value;
+        case 1: return lux_results.R_value;
+        case 2: return lux_results.G_value;
+        case 3: return lux_results.B_value;
+        case 4: return lux_results.W_value;
+        default: return 0;
     }
-    if (print_value) str.concat(lux_results.W_value);
 }
@@ -17,9 +17,27 @@
     TinyGsm modem(SERIAL_AT);
 #endif
 
+/* Modem client whose connections are bounded by MODEM_MQTT_CONNECT_S instead of the default
+ * +CIPSTART timeout (75 s), since the broker is reconnected from the capture loop */
+class Modem_MQTT_Client : public TinyGsmClient {
+public:
+    Modem_MQTT_Client(TinyGsm &modem, uint8_t mux) : TinyGsmClient(modem, mux) {}
+
+    int connect(const char *host, uint16_t port) override {
+        return TinyGsmClient::connect(host, port, MODEM_MQTT_CONNECT_S);
+    }
+
+    int connect(IPAddress ip, uint16_t port) override {
+        return TinyGsmClient::connect(ip, port, MODEM_MQTT_CONNECT_S);
+    }
+};
+
 TinyGsmClient client(modem);                               // GSM Modem client
+Modem_MQTT_Client *mqtt_client = NULL;                     // GSM Modem client of the MQTT broker connection (only on GPRS)
+Modem_Session modem_session(modem);                        // Long-lived GPRS session
 
 extern bool DEBUG;
+extern uint8_t net_tx_buff[NET_TX_BUFF_SIZE];              // Coalesced output, shared with the web server
 
 
 bool ETH_initialize(EthernetClass *eth, uint8_t *mac) {
@@ -35,24 +53,26 @@ bool ETH_initialize(EthernetClass *eth, uint8_t *mac) {
     return true;
 }
 
-bool ETH_send_data_http_server(const char *host, uint16_t port, String *str_out) {
+bool ETH_send_data_http_server(const char *host, uint16_t port, const char *str_out) {
     EthernetClient eth_cli;
+    Buffered_Client out(eth_cli, net_tx_buff, sizeof(net_tx_buff));   // The request is sent in one segment
 
     eth_cli.stop();
 
     // if there's a successful connection:
-    if (eth_cli.connect(host, port)) {
+    if (out.connect(host, port)) {
         DEBUG_V2(F("Connecting to "), host)
 
         // Send string to internet
-        eth_cli.println(F("GET "));
-        eth_cli.print(*str_out);                        // GET /search.asp?xxx
-        eth_cli.println(F(" HTTP/1.1"));
-        eth_cli.print(F("Host: "));
-        eth_cli.println(host);              // ${server_addr} \r\n
-        eth_cli.println(F("User-Agent: arduino-mcu"));
-        eth_cli.println(F("Connection: close"));
-        eth_cli.println();
+        out.print(F("GET "));
+        out.print(str_out);                             // GET /search.asp?xxx
+        out.println(F(" HTTP/1.1"));
+        out.print(F("Host: "));
+        out.println(host);                  // ${server_addr} \r\n
+        out.println(F("User-Agent: arduino-mcu"));
+        out.println(F("Connection: close"));
+        out.println();
+        out.flush();
 
         return true;
     }
@@ -64,75 +84,54 @@ bool ETH_send_data_http_server(const char *host, uint16_t port, String *str_out)
     }
 }
 
-bool MODEM_connect_network() {
-    DEBUG_NL(F("[Modem] Waiting for network..."))
+void MODEM_begin() {
+    SERIAL_AT.begin(9600);                                 // Set GSM module baud rate
+    modem_session.begin();
+}
 
-    if (!modem.waitForNetwork()) {
-        DEBUG_NL(F("  > Network fail"))
-        return false;
-    }
-    else {
-        DEBUG_NL(F("  > Network OK"))
-        return true;
-    }
+void MODEM_loop() {
+    modem_session.loop();
 }
 
-bool MODEM_send_data(String *str_out, const char *host, uint16_t port) {
-    // Set GSM module baud rate
-    SERIAL_AT.begin(9600);
-    delay(3000);
+bool MODEM_is_ready() {
+    return modem_session.is_ready();
+}
 
-    DEBUG_NL(F("[Modem] Initializing.."))
-    
-    if (!modem.restart()) {
-        DEBUG_NL(F("  > Init fail"))
-        return false;
-    }
+Client &MODEM_get_mqtt_client() {
+    if (!mqtt_client)                                      // Created on demand, its RX FIFO is not needed on Ethernet
+        mqtt_client = new Modem_MQTT_Client(modem, MODEM_MQTT_MUX);
 
-    DEBUG_NL(F("  > Init OK"))
-    DEBUG_V2(F("  > Modem: "), modem.getModemInfo())
+    return *mqtt_client;
+}
 
-    if (!MODEM_connect_network()) {
-        DEBUG_NL(F("[Modem] fail!"))
+bool MODEM_send_data(const char *str_out, const char *host, uint16_t port) {
+    if (!modem_session.is_ready()) {                       // The session is established in background
+        DEBUG_NL(F("[Modem] GPRS session not ready"))
         return false;
     }
 
-    // Unlock your SIM card with a PIN
-    // Network OK
-    DEBUG_V2(F("Connecting to "), GPRS_APN)
-
-    if (!modem.gprsConnect(GPRS_APN, GPRS_USER, GPRS_PASS)) {
-        DEBUG_NL(F("GRPS [fail]"))
+    Buffered_Client out(client, net_tx_buff, sizeof(net_tx_buff));   // One AT send command for the whole request
 
-        return false;
-    }
-    
-    IPAddress local = modem.localIP();
-    DEBUG_NL(F("GPRS [OK]"))
-    DEBUG_V2(F("Local IP: "), local)
     DEBUG_V2(F("Connecting to "), host)
         
-    if (!client.connect(host, port)) {
-        SERIAL_MON.println(F("  > Connect fail")); 
+    if (!out.connect(host, port)) {
+        DEBUG_NL(F("  > Connect fail"))
+        modem_session.report_failure();                    // Check the link in the next step
         return false;
     }
 
     DEBUG_NL(F("Server [OK]"))
     
     // Make a HTTP GET request:
-    client.print(F("GET "));
-    client.print(*str_out);
-    client.print(F(" HTTP/1.0"));
-    client.print(F("Host: "));
-    client.println(host);
-    client.println(F("Connection: close\r\n"));
-    client.stop();
+    out.print(F("GET "));
+    out.print(str_out);
+    out.println(F(" HTTP/1.0"));
+    out.print(F("Host: "));
+    out.println(host);
+    out.println(F("Connection: close\r\n"));
+    out.stop();                                            // Send the request. The GPRS session stays up
 
     DEBUG_NL(F("\nServer disconnected"))
     
-    modem.gprsDisconnect();
-    DEBUG_NL(F("GPRS disconnected"))
-    
     return true;
 }
-
@@ -0,0 +1,254 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * HTTP_Request class used to parse the requests received by the embedded web server.
+ * The parser is incremental (fed one byte at a time, in constant time) and works over
+ * fixed buffers: only the method, the target (path + query) and the values of the known
+ * headers (Connection, If-None-Match, Accept-Encoding) are stored, the rest of the headers
+ * are validated and skipped. The limits are checked as soon as they are exceeded, so the
+ * request can be answered (414/400) without reading the rest of it
+ *
+ */
+
+#include "HTTP_Request.h"
+
+static const char HTTP_VERSION_PREFIX[] PROGMEM = "HTTP/1.";
+#define HTTP_VERSION_PREFIX_LEN    7
+
+static const char HDR_CONNECTION[] PROGMEM = "connection";
+static const char HDR_IF_NONE_MATCH[] PROGMEM = "if-none-match";
+static const char HDR_ACCEPT_ENCODING[] PROGMEM = "accept-encoding";
+static const char * const KNOWN_HEADERS[] PROGMEM = {     // Names in lowercase, in Header_id_t order
+    HDR_CONNECTION,
+    HDR_IF_NONE_MATCH,
+    HDR_ACCEPT_ENCODING
+};
+
+
+HTTP_Request::HTTP_Request() {
+    reset();
+}
+
+void HTTP_Request::reset() {
+    state     = ps_Method;
+    result    = pr_Incomplete;
+    method[0] = '\0';
+    target[0] = '\0';
+    query_pos = 0;
+    len       = 0;
+    n_headers = 0;
+    keep_alive = false;
+    if_none_match[0] = '\0';
+    accept_gzip = true;
+    in_value  = false;
+    hdr_candidates = (1 << hdr_N_known) - 1;
+    hdr_id    = hdr_Unknown;
+    value_len = 0;
+}
+
+HTTP_Request::Parse_result_t HTTP_Request::feed(char c) {
+    switch (state) {
+        case ps_Method:
+            if (c == ' ') {
+                if (len == 0) return finish(pr_Bad_request);
+                state = ps_Target;
+                len = 0;
+            } else if (c < 'A' || c > 'Z' || len >= ACT_WEBSRV_MAX_METHOD_LEN) {
+                return finish(pr_Bad_request);
+            } else {
+                method[len++] = c;
+                method[len] = '\0';
+            }
+            break;
+
+        case ps_Target:
+            if (c == ' ') {
+                if (len == 0) return finish(pr_Bad_request);
+                state = ps_Version;
+                len = 0;
+            } else if (c == '\r' || c == '\n' || (len == 0 && c != '/')) {
+                return finish(pr_Bad_request);             // Only the origin form (absolute path) is accepted
+            } else if (len >= ACT_WEBSRV_MAX_TARGET_LEN) {
+                return finish(pr_URI_too_long);
+            } else {
+                if (c == '?' && query_pos == 0) query_pos = len + 1;
+                target[len++] = c;
+                target[len] = '\0';
+            }
+            break;
+
+        case ps_Version:                                   // "HTTP/1.x"
+            if (c == '\r' && len == HTTP_VERSION_PREFIX_LEN + 1) {
+                break;
+            } else if (c == '\n' && len == HTTP_VERSION_PREFIX_LEN + 1) {
+                state = ps_Header;
+                len = 0;
+            } else if (len < HTTP_VERSION_PREFIX_LEN && c == (char)pgm_read_byte(&HTTP_VERSION_PREFIX[len])) {
+                len++;
+            } else if (len == HTTP_VERSION_PREFIX_LEN && c >= '0' && c <= '9') {
+                keep_alive = (c >= '1');                   // HTTP/1.1 connections are persistent by default
+                len++;
+            } else {
+                return finish(pr_Bad_request);
+            }
+            break;
+
+        case ps_Header:
+            if (c == '\r') {
+                break;
+            } else if (c == '\n') {
+                if (len == 0) return finish(pr_Done);      // Empty line: end of the headers
+                if (++n_headers > ACT_WEBSRV_MAX_HEADERS) return finish(pr_Bad_request);
+                end_header();
+            } else if (++len > ACT_WEBSRV_MAX_HEADER_LEN) {
+                return finish(pr_Bad_request);
+            } else {
+                parse_header(c);
+            }
+            break;
+
+        case ps_End:
+            break;
+    }
+
+    return result;
+}
+
+const char *HTTP_Request::get_method() const {
+    return method;
+}
+
+const char *HTTP_Request::get_target() const {
+    return target;
+}
+
+const char *HTTP_Request::get_query() const {
+    return (query_pos > 0)? target + query_pos : target + strlen(target);
+}
+
+bool HTTP_Request::is_get() const {
+    return (strcmp(method, "GET") == 0);
+}
+
+bool HTTP_Request::target_starts_with(const __FlashStringHelper *prefix) const {
+    PGM_P p = reinterpret_cast<PGM_P>(prefix);
+
+    return (strncmp_P(target, p, strlen_P(p)) == 0);
+}
+
+bool HTTP_Request::is_keep_alive() const {
+    return keep_alive;
+}
+
+bool HTTP_Request::is_etag_cached(const char *etag) const {
+    if (if_none_match[0] == '\0') return false;
+
+    return (strcmp(if_none_match, "*") == 0 || strstr(if_none_match, etag) != NULL);
+}
+
+bool HTTP_Request::is_gzip_accepted() const {
+    return accept_gzip;
+}
+
+void HTTP_Request::parse_header(char c) {
+    if (in_value) {
+        if (hdr_id == hdr_Unknown) return;                 // Value not needed
+        if (value_len == 0 && (c == ' ' || c == '\t')) return;
+        if (value_len < ACT_WEBSRV_HDR_VALUE_LEN) hdr_value[value_len++] = c;
+        return;
+    }
+
+    uint8_t pos = len - 1;                                 // Position of the char in the name
+
+    if (c == ':') {                                        // End of the name: a known header must match completely
+        in_value = true;
+        for (uint8_t i=0; i < hdr_N_known; i++) {
+            if ((hdr_candidates & (1 << i)) && strlen_P((PGM_P)pgm_read_ptr(&KNOWN_HEADERS[i])) == pos)
+                hdr_id = (Header_id_t)i;
+        }
+        return;
+    }
+
+    for (uint8_t i=0; i < hdr_N_known && hdr_candidates; i++) {   // Names are compared case-insensitively
+        PGM_P name = (PGM_P)pgm_read_ptr(&KNOWN_HEADERS[i]);
+        if ((hdr_candidates & (1 << i)) && (char)pgm_read_byte(&name[pos]) != tolower(c))
+            hdr_candidates &= ~(1 << i);                   // The terminator never matches, so longer names are discarded
+    }
+}
+
+void HTTP_Request::end_header() {
+    while (value_len > 0 && (hdr_value[value_len-1] == ' ' || hdr_value[value_len-1] == '\t'))
+        value_len--;
+    hdr_value[value_len] = '\0';
+
+    switch (hdr_id) {
+        case hdr_Connection:                               // e.g. "close", "keep-alive" or "keep-alive, Upgrade"
+            if (strcasestr(hdr_value, "close") != NULL)
+                keep_alive = false;
+            else if (strcasestr(hdr_value, "keep-alive") != NULL)
+                keep_alive = true;
+            break;
+
+        case hdr_If_none_match:                            // e.g. "\"12-1600000000\"" or "*"
+            strcpy(if_none_match, hdr_value);
+            break;
+
+        case hdr_Accept_encoding:                          // e.g. "gzip, deflate, br" or "*;q=0.5, gzip;q=0"
+            accept_gzip = parse_accept_gzip(hdr_value);
+            break;
+
+        default:
+            break;
+    }
+
+    len       = 0;                                         // Start the next line
+    in_value  = false;
+    hdr_candidates = (1 << hdr_N_known) - 1;
+    hdr_id    = hdr_Unknown;
+    value_len = 0;
+}
+
+bool HTTP_Request::parse_accept_gzip(const char *value) {
+    int8_t gzip_q = -1, any_q = -1;                        // -1 = not listed, 0 = refused (q=0), 1 = accepted
+    const char *p = value;
+
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        const char *name = p;
+        while (*p && *p != ',' && *p != ';' && *p != ' ' && *p != '\t') p++;
+        uint8_t name_len = p - name;
+        int8_t q = 1;
+
+        while (*p && *p != ',') {                          // Parameters of the coding, only q matters
+            if (*p++ != ';') continue;
+            while (*p == ' ' || *p == '\t') p++;
+            if ((*p != 'q' && *p != 'Q') || p[1] != '=') continue;
+
+            p += 2;                                        // q is zero only as "0", "0." or "0.000"
+            q = (*p == '0')? 0 : 1;
+            if (*p) p++;
+            if (q == 0 && *p == '.') {
+                do { p++; } while (*p == '0');
+                if (*p >= '1' && *p <= '9') q = 1;
+            }
+        }
+
+        if (name_len == 4 && strncasecmp(name, "gzip", 4) == 0)
+            gzip_q = q;
+        else if (name_len == 1 && *name == '*')
+            any_q = q;
+    }
+
+    if (gzip_q >= 0) return (gzip_q > 0);                  // The coding itself rules over "*"
+
+    return (any_q > 0);                                    // Not listed: only acceptable through "*"
+}
+
+HTTP_Request::Parse_result_t HTTP_Request::finish(Parse_result_t res) {
+    state  = ps_End;
+    result = res;
+
+    return result;
+}
@@ -55,14 +55,16 @@ void SD_load_culture_ID(IniFile *ini, Culture_ID_st *culture_id) {
     }
 }
 
-void SD_load_MQTT_config(IniFile *ini, MQTT_Pub *&mqtt_pub, Culture_ID_st *culture_id) {
+void SD_load_MQTT_config(IniFile *ini, MQTT_Pub *&mqtt_pub, Culture_ID_st *culture_id, Client &client) {
     char buffer[INI_FILE_BUFFER_LEN] = "";
     const char *section = "rpt:MQTT";
     MQTT_Cnn_st mqtt_info = {                              // MQTT broker connection information
         MQTT_SERVER_DEST,
         MQTT_PORT_DEST,
         MQTT_BROKER_USR,
-        MQTT_BROKER_PSW
+        MQTT_BROKER_PSW,
+        MQTT_DEF_BATCH_SIZE,
+        MQTT_DEF_ENCODING
     };
     
     DEBUG_NL(F("Loading MQTT conn. info.."))
@@ -77,9 +79,23 @@ void SD_load_MQTT_config(IniFile *ini, MQTT_Pub *&mqtt_pub, Culture_ID_st *cultu
 
     if (ini->getValue(section, "psw", buffer, sizeof(buffer)))
         strncpy(mqtt_info.psw, buffer, 20);
+
+    if (ini->getValue(section, "batch_size", buffer, sizeof(buffer))) {
+        int batch_size = atoi(buffer);
+        mqtt_info.batch_size = constrain(batch_size, 1, MQTT_MAX_BATCH_SIZE);
+    }
+
+    if (ini->getValue(section, "encoding", buffer, sizeof(buffer))) {
+        if (strcmp(buffer, "cbor") == 0)
+            mqtt_info.encoding = pe_cbor;
+        else if (strcmp(buffer, "cbor_delta") == 0)
+            mqtt_info.encoding = pe_cbor_delta;
+        else
+            mqtt_info.encoding = pe_text;
+    }
     
     // Instanciate MQTT publisher
-    mqtt_pub = new MQTT_Pub(&mqtt_info, culture_id);
+    mqtt_pub = new MQTT_Pub(&mqtt_info, culture_id, client);
 }
 
 void SD_load_Cnn_type(IniFile *ini, Internet_cnn_type &option) {
@@ -132,13 +148,23 @@ void SD_load_Eth_config(IniFile *ini, uint8_t *mac) {
     }
 }
 
-void SD_load_DHT_sensors(IniFile *ini, DHT_Sensors* sensors) {
+void SD_load_period(IniFile *ini, const char *section, uint16_t &period_s) {
+   	char buffer[INI_FILE_BUFFER_LEN] = "";
+
+    if (ini->getValue(section, "period_s", buffer, sizeof(buffer), period_s)) {
+        if (period_s < SCHED_MIN_PERIOD_S) period_s = SCHED_MIN_PERIOD_S;
+        if (DEBUG) { SERIAL_MON.print(F("  > Sampling period (s) = ")); SERIAL_MON.println(period_s); }
+    }
+}
+
+void SD_load_DHT_sensors(IniFile *ini, DHT_Sensors* sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[14] = "";
 	bool found;
 	uint8_t i = 1;
 
 	DEBUG_NL(F("Loading DHT sensors config.."))
+	SD_load_period(ini, "sensors:DHT", period_s);
 	do {
 		sprintf(tag_sensor, "sensor%d.pin", i++);
 		found = ini->getValue("sensors:DHT", tag_sensor, buffer, sizeof(buffer));
@@ -165,10 +191,11 @@ void SD_load_DHT_sensors(IniFile *ini, DHT_Sensors* sensors) {
 	}
 }
 
-void SD_load_DO_sensor(IniFile *ini, DO_Sensor* sensor) {
+void SD_load_DO_sensor(IniFile *ini, DO_Sensor* sensor, uint16_t &period_s) {
    	char buffer[INI_FILE_BUFFER_LEN] = "";
     
     DEBUG_NL(F("Loading DO sensor config.."))
+    SD_load_period(ini, "sensor:DO", period_s);
 
     // Read DO sensor address (hexadecimal format)
     if (ini->getValue("sensor:DO", "address", buffer, sizeof(buffer))) {
@@ -199,13 +226,14 @@ void SD_load_DO_sensor(IniFile *ini, DO_Sensor* sensor) {
     }
 }
 
-void SD_load_pH_sensors(IniFile *ini, PH_Sensors *&sensors) {
+void SD_load_pH_sensors(IniFile *ini, PH_Sensors *&sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[14] = "";
 	bool found;
 	uint8_t i = 1;
 
 	DEBUG_NL(F("Loading pH sensors config.."))
+	SD_load_period(ini, "sensors:pH", period_s);
 	do {
 		sprintf(tag_sensor, "sensor%d.pin", i++);
 		found = ini->getValue("sensors:pH", tag_sensor, buffer, sizeof(buffer));
@@ -259,7 +287,7 @@ bool extract_str_params_Lux_sensor(char *str, Lux_Sensors::Lux_Sensor_model_t &m
     return true;
 }
 
-void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors) {
+void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[11] = "";
     bool sens_cfg;
@@ -268,6 +296,7 @@ void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors) {
     Lux_Sensors::Lux_Sensor_model_t s_model;
 
     DEBUG_NL(F("Loading Lux sensors config.."))
+    SD_load_period(ini, "sensors:lux", period_s);
     do {
 		sprintf(tag_sensor, "sensor%d", i++);
 		sens_cfg = ini->getValue("sensors:lux", tag_sensor, buffer, sizeof(buffer));
@@ -311,13 +340,14 @@ void SD_load_Lux_sensors(IniFile *ini, Lux_Sensors *&sensors) {
     }
 }
 
-void SD_load_ORP_sensors(IniFile *ini, ORP_Sensors *&sensors) {
+void SD_load_ORP_sensors(IniFile *ini, ORP_Sensors *&sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[15] = "";
 	bool found;
 	uint8_t i = 1;
     
 	DEBUG_NL(F("Loading ORP sensors config.."))
+	SD_load_period(ini, "sensors:ORP", period_s);
 	do {
 		sprintf(tag_sensor, "sensor%d.addr", i++);
 		found = ini->getValue("sensors:ORP", tag_sensor, buffer, sizeof(buffer));
@@ -344,13 +374,14 @@ void SD_load_ORP_sensors(IniFile *ini, ORP_Sensors *&sensors) {
 	}
 }
 
-void SD_load_WP_Temp_sensors(IniFile *ini, WP_Temp_Sensors *&sensors) {
+void SD_load_WP_Temp_sensors(IniFile *ini, WP_Temp_Sensors *&sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[20] = "";
-    uint8_t i=1, addr_s[8], addr_b[8];
+    uint8_t i=1, addr_s[8], addr_b[8], resolution;
 	uint16_t one_wire_pin;
 
     DEBUG_NL(F("Loading WP temperature sensors config.."))
+    SD_load_period(ini, "sensors:wp_temp", period_s);
     
     bool found = ini->getValue("sensors:wp_temp", "one_wire_pin",
                                 buffer, sizeof(buffer), one_wire_pin); // Load One Wire config
@@ -366,13 +397,18 @@ void SD_load_WP_Temp_sensors(IniFile *ini, WP_Temp_Sensors *&sensors) {
         found = ini->getValue("sensors:wp_temp", tag_sensor, buffer, sizeof(buffer));
         if (!found || !convert_str_to_addr(buffer, addr_b, 8)) break; // If can't find the sensor or the address is not correct, exit
 
+        // Load resolution of the pair
+        sprintf(tag_sensor, "res_t%d", i);
+        if (!ini->getValue("sensors:wp_temp", tag_sensor, buffer, sizeof(buffer), resolution))
+            resolution = WP_T_DEF_RESOLUTION;
+
         if (DEBUG) {
             SERIAL_MON.print(F("  > Found config: sensor")); SERIAL_MON.print(i);
-            SERIAL_MON.println(F(" pair"));
+            SERIAL_MON.print(F(" pair. Resolution = ")); SERIAL_MON.println(resolution);
         }
         
         if (!sensors) sensors = new WP_Temp_Sensors(one_wire_pin);    // If the obj has not been initialized yet, we do it now
-        sensors->add_sensors_pair(addr_s, addr_b);
+        sensors->add_sensors_pair(addr_s, addr_b, resolution);
 
         i++;
 	}
@@ -420,7 +456,7 @@ bool extract_str_params_Current_sensor(char *str, uint8_t &pin, Current_Sensors:
     return true;
 }
 
-void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors) {
+void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors, uint16_t &period_s) {
 	char buffer[INI_FILE_BUFFER_LEN] = "";
 	char tag_sensor[11] = "";
     bool sens_cfg;
@@ -430,6 +466,7 @@ void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors) {
     uint16_t var;
 
     DEBUG_NL(F("Loading Current sensors config.."))
+    SD_load_period(ini, "sensors:current", period_s);
     do {
 		sprintf(tag_sensor, "sensor%d", i++);
 		sens_cfg = ini->getValue("sensors:current", tag_sensor, buffer, sizeof(buffer));
@@ -460,6 +497,23 @@ void SD_load_Current_sensors(IniFile *ini, Current_Sensors *&sensors) {
             }
         }
     }
+
+    if (!sensors) return;
+
+    // Load true-RMS metering configuration
+    bool metering = CURR_METER_DEF_ENABLED;
+    uint8_t mains_hz = CURR_METER_DEF_MAINS_HZ;
+    uint16_t voltage = CURR_METER_DEF_VOLTAGE;
+
+    ini->getValue("sensors:current", "metering", buffer, sizeof(buffer), metering);
+    ini->getValue("sensors:current", "mains_hz", buffer, sizeof(buffer), mains_hz);
+    ini->getValue("sensors:current", "voltage", buffer, sizeof(buffer), voltage);
+
+    if (DEBUG && metering) {
+        SERIAL_MON.print(F("  > Metering mode: ")); SERIAL_MON.print(mains_hz);
+        SERIAL_MON.print(F(" Hz, ")); SERIAL_MON.print(voltage); SERIAL_MON.println(F(" V"));
+    }
+    sensors->set_metering(metering, mains_hz, voltage);
 }
 
 bool extract_params_Actuator(char *str, uint8_t &dev_pin, char *dev_id, uint8_t &ini_val) {
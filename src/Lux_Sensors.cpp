@@ -97,18 +97,21 @@ Lux_Sensors::Lux_Sensor_model_t Lux_Sensors::get_model_sensors(uint8_t n_sensor)
     return lux_sensors[n_sensor].model;
 }
 
-void Lux_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
-
-    for (uint8_t i=0; i<get_n_sensors(); i++) {
-        if (i && delim != '\0') str.concat(delim);
-        if (print_tag) {
-            str.concat(F("Lux"));
-            str += i+1;
-
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(lux_sensors[i].read_val);
-    }
+bool Lux_Sensors::poll_capture() {
+    capture_all_sensors();
+    return true;
+}
+
+const uint8_t Lux_Sensors::get_n_channels() {
+    return get_n_sensors();
+}
+
+Channel_type_t Lux_Sensors::get_channel_type(uint8_t ch) {
+    return ct_Lux;
+}
+
+const float Lux_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= get_n_sensors()) return 0;
+
+    return lux_sensors[ch].read_val;
 }
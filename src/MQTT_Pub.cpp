@@ -12,26 +12,376 @@
 extern bool DEBUG;
 
 
-MQTT_Pub::MQTT_Pub(MQTT_Cnn_st *_mqtt_inf, Culture_ID_st *_culture_id)
+MQTT_Pub *MQTT_Pub::cmd_instance = NULL;
+
+
+/* Find the end of the field that starts at p (the next comma or the end of the fields) */
+static const char *field_end(const char *p, const char *end) {
+    const char *comma = (const char *)memchr(p, ',', end - p);
+
+    return comma? comma : end;
+}
+
+MQTT_Pub::MQTT_Pub(MQTT_Cnn_st *_mqtt_inf, Culture_ID_st *_culture_id, Client &client)
+    : batch(batch_buff, sizeof(batch_buff))
 {
     memcpy(&mqtt_inf, _mqtt_inf, sizeof(MQTT_Cnn_st));        // Copy the MQTT connection inf.
     memcpy(&culture_id, _culture_id, sizeof(Culture_ID_st));  // Copy the culture ID struct
     sprintf(pub_topic, "%s/sensors", culture_id.host_id);     // Compose topic to publish
+    sprintf(cbor_topic, "%s/sensors/cbor", culture_id.host_id);
 
-    mqtt_cli.setClient(eth_cli);
+    Record_Writer pfx(prefix, sizeof(prefix));                // Render once the measurement & tags
+    pfx.print(F(INFLUXDB_MEASUREMENT));
+    add_tags_struct(pfx);
+    pfx.print(' ');
+    prefix_len = pfx.length();
+
+    n_batch = 0;
+    cbor_seq = 0;
+    cbor_n_delta = 0;                                         // The first CBOR message has the absolute values
+    memset(cbor_ref, 0, sizeof(cbor_ref));
+    max_payload = MQTT_MAX_PACKET_SIZE - MQTT_MAX_HEADER_SIZE - 2 - strlen(pub_topic);
+
+    session_up = false;
+    connected_ms = 0;
+    next_attempt_ms = 0;
+    n_retries = 0;
+    n_connect_fails = 0;
+    actuators = NULL;
+
+    uint32_t seed = micros();                                 // Different jitter on each board
+    for (const char *c = culture_id.host_id; *c; c++) seed = seed * 31 + *c;
+    randomSeed(seed);
+
+    mqtt_cli.setClient(client);
     mqtt_cli.setServer(mqtt_inf.server, mqtt_inf.port);
+    mqtt_cli.setSocketTimeout(MQTT_SOCKET_TIMEOUT_S);         // Bounded wait for the broker answers
 }
 
 bool MQTT_Pub::broker_reconnect() {
+    if (n_retries > 0 && (int32_t)(millis() - next_attempt_ms) < 0)
+        return false;                                      // Backoff not expired, do not block
+
     DEBUG_NL(F("[I] MQTT reconnect:"))
     DEBUG_V2(F("  > ID : "), culture_id.host_id)
     DEBUG_V2(F("  > Usr: "), mqtt_inf.usr)
     DEBUG_V2(F("  > Psw: "), mqtt_inf.psw)
 
-    return mqtt_cli.connect(culture_id.host_id, mqtt_inf.usr, mqtt_inf.psw);
+    if (mqtt_cli.connect(culture_id.host_id, mqtt_inf.usr, mqtt_inf.psw)) {
+        session_up = true;
+        connected_ms = millis();
+        n_retries = 0;
+
+        if (actuators) subscribe_actuators();              // The subscriptions do not survive the session
+
+        return true;
+    }
+
+    n_connect_fails++;
+    if (n_retries < 255) n_retries++;
+
+    // Exponential backoff with jitter: a random wait between half and the whole backoff
+    uint32_t backoff = min((uint32_t)MQTT_BACKOFF_MIN_MS << min(n_retries - 1, 10), (uint32_t)MQTT_BACKOFF_MAX_MS);
+    backoff = backoff / 2 + random(backoff / 2 + 1);
+    next_attempt_ms = millis() + backoff;
+
+    DEBUG_V3(F("  > Failed (rc="), mqtt_cli.state(), F(")"))
+    DEBUG_V2(F("  > Next attempt in (ms): "), backoff)
+
+    return false;
+}
+
+bool MQTT_Pub::is_connected() {
+    return mqtt_cli.connected();
+}
+
+const uint32_t MQTT_Pub::get_n_connect_fails() {
+    return n_connect_fails;
+}
+
+const uint32_t MQTT_Pub::get_uptime_s() {
+    return session_up? (millis() - connected_ms) / 1000 : 0;
 }
 
 bool MQTT_Pub::publish_topic(const char *payload) {
+    const char *sep = strchr(payload, ' ');                // Optional timestamp after the fields
+
+    if (sep)
+        return publish_fields(payload, sep - payload, strtoul(sep + 1, NULL, 10));
+
+    return publish_fields(payload, strlen(payload), 0);
+}
+
+int8_t MQTT_Pub::add_sample(const char *fields, uint32_t timestamp) {
+    if (timestamp == 0 || mqtt_inf.batch_size <= 1) {      // No batching (or no time to stamp the samples)
+        size_t len = strlen(fields);
+        bool split = (prefix_len + len > max_payload);     // The parts of a split record share the timestamp
+
+        flush_batch();
+
+        return publish_fields(fields, len, split? timestamp : 0)? MQTT_SAMPLE_SENT : MQTT_SAMPLE_REJECTED;
+    }
+
+    // A full batch (by number of samples or size) must be published before adding the sample
+    if (n_batch >= mqtt_inf.batch_size || !add_line(fields, timestamp)) {
+        if (n_batch > 0 && !flush_batch())
+            return MQTT_SAMPLE_REJECTED;
+
+        if (!add_line(fields, timestamp))                  // Larger than a packet, it is split in several messages
+            return publish_fields(fields, strlen(fields), timestamp)? MQTT_SAMPLE_SENT : MQTT_SAMPLE_REJECTED;
+    }
+
+    if (n_batch < mqtt_inf.batch_size) return MQTT_SAMPLE_BUFFERED;
+
+    return flush_batch()? MQTT_SAMPLE_SENT : MQTT_SAMPLE_BUFFERED;   // On error, it is retried with the next sample
+}
+
+bool MQTT_Pub::flush_batch() {
+    if (n_batch == 0) return true;
+
+    DEBUG_V2(F("[I] Publishing batch of samples: "), n_batch)
+
+    if (!begin_msg(pub_topic, get_batch_payload(batch.length(), n_batch))) return false;
+
+    const char *line = batch.c_str();
+
+    for (uint8_t i=0; i < n_batch; i++) {                  // The lines are stored without the prefix
+        const char *line_end = strchr(line, '\n');
+        size_t line_len = line_end? line_end - line : strlen(line);
+
+        if (i > 0) mqtt_cli.write('\n');
+        mqtt_cli.write((const uint8_t *)prefix, prefix_len);
+        mqtt_cli.write((const uint8_t *)line, line_len);
+
+        line += line_len + 1;
+    }
+
+    if (!end_msg()) return false;
+
+    batch.reset();
+    n_batch = 0;
+
+    return true;
+}
+
+bool MQTT_Pub::add_line(const char *fields, uint32_t timestamp) {
+    size_t prev_len = batch.length();
+
+    if (n_batch > 0) batch.print('\n');                   // One line per sample
+
+    batch.print(fields);
+    batch.print(' ');
+    batch.print(timestamp);                                // Line protocol timestamp (precision in seconds)
+
+    if (batch.is_overflow() || get_batch_payload(batch.length(), n_batch + 1) > max_payload) {
+        batch.truncate(prev_len);                          // It does not fit, keep the previous samples
+        return false;
+    }
+
+    n_batch++;
+
+    return true;
+}
+
+bool MQTT_Pub::publish_fields(const char *fields, size_t len, uint32_t timestamp) {
+    const char *end = fields + len;
+    char ts[12] = "";
+    size_t ts_len = 0;
+    uint8_t n_parts = 0;
+
+    if (timestamp > 0) ts_len = sprintf(ts, " %lu", (unsigned long)timestamp);
+
+    while (fields < end) {
+        const char *part_end = fields;                     // The fields of a part are contiguous in the record
+
+        while (part_end < end) {                           // Adding the fields that fit in the packet
+            const char *f_end = field_end(part_end == fields? part_end : part_end + 1, end);
+
+            if (prefix_len + (f_end - fields) + ts_len > max_payload) break;
+
+            part_end = f_end;
+        }
+
+        if (part_end == fields) {                          // A single field does not fit in the packet
+            DEBUG_V2(F("[!] WARNING! Field discarded, larger than "), max_payload)
+
+            part_end = field_end(fields, end);
+            fields = (part_end < end)? part_end + 1 : end;
+            continue;
+        }
+
+        // Stream the prefix, the fields & the timestamp straight to the client (without copies)
+        if (!begin_msg(pub_topic, prefix_len + (part_end - fields) + ts_len)) return false;
+
+        mqtt_cli.write((const uint8_t *)prefix, prefix_len);
+        mqtt_cli.write((const uint8_t *)fields, part_end - fields);
+        mqtt_cli.write((const uint8_t *)ts, ts_len);
+
+        if (!end_msg()) return false;
+
+        fields = (part_end < end)? part_end + 1 : end;
+        n_parts++;
+    }
+
+    if (n_parts > 1) DEBUG_V2(F("[I] Record split in messages: "), n_parts)
+
+    return true;
+}
+
+bool MQTT_Pub::publish_cbor(Sensor_Registry &registry, uint32_t timestamp, int32_t q_depth) {
+    if (n_batch > 0 && !flush_batch()) return false;      // The batch buffer is used to encode the message
+
+    CBOR_Writer msg((uint8_t *)batch_buff, max_payload);
+    bool key = (cbor_n_delta == 0);                        // Key message: tags & absolute values of all the channels
+    bool delta = (mqtt_inf.encoding == pe_cbor_delta && !key);
+
+    msg.begin_map(2 + (timestamp > 0) + key + (q_depth >= 0));
+    msg.put_uint(0);
+    msg.put_uint(cbor_seq);                                // Lets the decoder detect lost messages
+
+    if (timestamp > 0) {
+        msg.put_uint(1);
+        msg.put_uint(timestamp);
+    }
+
+    if (key) {
+        msg.put_uint(2);
+        msg.begin_array(3);
+        msg.put_text(culture_id.country);
+        msg.put_text(culture_id.city);
+        msg.put_text(culture_id.culture);
+    }
+
+    msg.put_uint(delta? 4 : 3);
+    msg.begin_indef_array();
+    registry.bulk_cbor(msg, cbor_ref, delta, !key);
+    msg.end_indef();
+
+    if (q_depth >= 0) {
+        msg.put_uint(5);
+        msg.put_uint(q_depth);
+    }
+
+    cbor_seq++;
+
+    if (msg.is_overflow()) {
+        DEBUG_V2(F("[!] WARNING! CBOR message > "), max_payload)
+        cbor_n_delta = 0;
+        return false;
+    }
+
+    bool res = begin_msg(cbor_topic, msg.length());
+
+    if (res) {
+        mqtt_cli.write(msg.data(), msg.length());
+        res = end_msg();
+    }
+
+    // After an error the decoder can not apply the deltas, the next message has the absolute values
+    cbor_n_delta = res? (cbor_n_delta + 1) % MQTT_CBOR_KEYFRAME_EVERY : 0;
+
+    return res;
+}
+
+Payload_enc_t MQTT_Pub::get_encoding() {
+    return mqtt_inf.encoding;
+}
+
+void MQTT_Pub::set_actuators(OS_Actuators *_actuators) {
+    actuators = _actuators;
+    cmd_instance = this;
+    mqtt_cli.setCallback(on_message);
+
+    if (mqtt_cli.connected()) subscribe_actuators();
+}
+
+bool MQTT_Pub::publish_actuator_state(const char *dev_id) {
+    if (!actuators || !mqtt_cli.connected()) return false;
+
+    uint8_t state = actuators->get_device_state_by_id(dev_id);
+    if (state == OS_ACTUATOR_NOT_DEF) return false;
+
+    return publish_actuator_msg(dev_id, F("/state"), (state == HIGH)? "ON" : "OFF");
+}
+
+void MQTT_Pub::on_message(char *topic, uint8_t *payload, unsigned int len) {
+    if (cmd_instance) cmd_instance->process_command(topic, payload, len);
+}
+
+void MQTT_Pub::process_command(const char *topic, const uint8_t *payload, unsigned int len) {
+    char act_prefix[MQTT_ACT_TOPIC_LEN];
+    char dev_id[ACT_MAX_DEV_ID_LEN+1] = "";
+    char cmd[8] = "";
+
+    // Topic: <host_id>/actuators/<dev_id>/set. The topic & payload are copied because
+    // they are in the client buffer, which is overwritten by the answers
+    size_t prefix_len = sprintf(act_prefix, "%s/actuators/", culture_id.host_id);
+    if (strncmp(topic, act_prefix, prefix_len) != 0) return;
+
+    const char *id = topic + prefix_len;
+    const char *id_end = strchr(id, '/');
+    if (!id_end || strcmp(id_end, "/set") != 0) return;
+
+    strncpy(dev_id, id, min((size_t)(id_end - id), (size_t)ACT_MAX_DEV_ID_LEN));
+    strncpy(cmd, (const char *)payload, min((size_t)len, sizeof(cmd) - 1));
+
+    uint8_t res = ACT_RES_PROCESS_OK;
+    uint8_t dev_action = LOW;
+
+    if (strcasecmp(cmd, "ON") == 0)
+        dev_action = HIGH;
+    else if (strcasecmp(cmd, "OFF") == 0)
+        dev_action = LOW;
+    else if (strcasecmp(cmd, "SWITCH") == 0)
+        dev_action = 0xFF;                                 // Indicates that status switch han been requested
+    else
+        res = ACT_RES_PARAM_ERROR;
+
+    DEBUG_V4(F("MQTT actuator: Apply <"), cmd, F("> on "), dev_id)
+
+    if (res == ACT_RES_PROCESS_OK && !actuators->change_state(dev_id, dev_action))
+        res = ACT_RES_ACT_UNDEF;
+
+    switch (res) {
+        case ACT_RES_PROCESS_OK:
+            publish_actuator_msg(dev_id, F("/ack"), "OK");
+            publish_actuator_state(dev_id);
+            break;
+
+        case ACT_RES_PARAM_ERROR:
+            publish_actuator_msg(dev_id, F("/ack"), "PARAM_ERROR");
+            break;
+
+        default:
+            publish_actuator_msg(dev_id, F("/ack"), "UNDEF");
+            break;
+    }
+}
+
+void MQTT_Pub::subscribe_actuators() {
+    char topic[MQTT_ACT_TOPIC_LEN];
+
+    sprintf(topic, "%s/actuators/+/set", culture_id.host_id);
+    if (!mqtt_cli.subscribe(topic))
+        DEBUG_NL(F("[E] ERROR subscribing to the actuators commands"))
+
+    for (uint8_t i=0; i < actuators->get_n_devices(); i++)  // Dashboards get the current states
+        publish_actuator_state(actuators->get_device_id(i));
+}
+
+bool MQTT_Pub::publish_actuator_msg(const char *dev_id, const __FlashStringHelper *leaf, const char *msg) {
+    char topic[MQTT_ACT_TOPIC_LEN];
+    Record_Writer topic_w(topic, sizeof(topic));
+
+    topic_w.print(culture_id.host_id);
+    topic_w.print(F("/actuators/"));
+    topic_w.print(dev_id);
+    topic_w.print(leaf);
+
+    return mqtt_cli.publish(topic, msg, true);             // Retained, for the new subscribers
+}
+
+bool MQTT_Pub::begin_msg(const char *topic, size_t len) {
     // If not connected to broker, try to reconnect
     if (!mqtt_cli.connected()) {
         DEBUG_NL(F("[I] Not connected to broker, try to reconnect.."))
@@ -45,26 +395,24 @@ bool MQTT_Pub::publish_topic(const char *payload) {
         }
     }
 
-    String str_tmp = F(INFLUXDB_MEASUREMENT);
-    add_tags_struct(&str_tmp);                             // Adding tags
-
-    str_tmp.concat(F(" "));
-    str_tmp.concat(payload);                               // Adding fields
-
     if (DEBUG) {
         DEBUG_NL(F("\nPublishing MQTT msg:"))
-        DEBUG_V2(F("  > Topic      = "), pub_topic)
-        DEBUG_V2(F("  > Payload    = "), str_tmp.c_str())
-        DEBUG_V2(F("  > Total size = "), MQTT_MAX_HEADER_SIZE + 2 + strlen(pub_topic) + str_tmp.length())
-
-        if (MQTT_MAX_PACKET_SIZE < MQTT_MAX_HEADER_SIZE + 2 
-                + strlen(pub_topic) + str_tmp.length())
-        {
-            DEBUG_V2(F("[!] WARNING! topic+payload+2 > "), MQTT_MAX_PACKET_SIZE)
-        }
+        DEBUG_V2(F("  > Topic      = "), topic)
+        if (topic == pub_topic) DEBUG_V2(F("  > Prefix     = "), prefix)
+        DEBUG_V2(F("  > Total size = "), MQTT_MAX_HEADER_SIZE + 2 + strlen(topic) + len)
     }
-    
-    if (!mqtt_cli.publish(pub_topic, str_tmp.c_str())) {
+
+    if (!mqtt_cli.beginPublish(topic, len, false)) {
+        DEBUG_NL(F("[E] ERROR sending topic"))
+
+        return false;
+    }
+
+    return true;
+}
+
+bool MQTT_Pub::end_msg() {
+    if (!mqtt_cli.endPublish()) {
         DEBUG_NL(F("[E] ERROR sending topic"))
 
         return false;
@@ -75,14 +423,32 @@ bool MQTT_Pub::publish_topic(const char *payload) {
     return true;
 }
 
-void MQTT_Pub::add_tags_struct(String *str_out) {
+size_t MQTT_Pub::get_batch_payload(size_t lines_len, uint8_t n_lines) {
+    return lines_len + n_lines * prefix_len;               // The separators are already counted in the lines
+}
+
+void MQTT_Pub::loop() {
+    if (mqtt_cli.connected()) {
+        mqtt_cli.loop();
+        return;
+    }
+
+    if (session_up) {                                      // The connection has been lost
+        DEBUG_V2(F("[I] MQTT connection lost. Uptime (s): "), get_uptime_s())
+        session_up = false;
+    }
+
+    broker_reconnect();                                    // Only when the backoff has expired
+}
+
+void MQTT_Pub::add_tags_struct(Print &out) {
     // Compose the tags stream data
-    (*str_out).concat(F(",country="));
-    (*str_out).concat(culture_id.country);
-    (*str_out).concat(F(",city="));
-    (*str_out).concat(culture_id.city);
-    (*str_out).concat(F(",culture="));
-    (*str_out).concat(culture_id.culture);
-    (*str_out).concat(F(",host="));
-    (*str_out).concat(culture_id.host_id);
+    out.print(F(",country="));
+    out.print(culture_id.country);
+    out.print(F(",city="));
+    out.print(culture_id.city);
+    out.print(F(",culture="));
+    out.print(culture_id.culture);
+    out.print(F(",host="));
+    out.print(culture_id.host_id);
 }
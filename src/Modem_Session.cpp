@@ -0,0 +1,229 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Modem_Session class used to keep a long-lived GPRS session (PDP context) with the modem.
+ * The session is driven by a non-blocking state machine: each call to loop() performs at
+ * most one step (one AT command with a short timeout, MODEM_AT_TIMEOUT_MS). The slow
+ * operations (GPRS attach, PDP context activation) are requested and then polled in the
+ * next steps, so a modem stall can not freeze the sampling loop.
+ * The link health is checked periodically and the session is reestablished only on
+ * failure, with an exponential backoff between the attempts
+ *
+ */
+
+#include "Modem_Session.h"
+
+extern bool DEBUG;
+
+
+Modem_Session::Modem_Session(TinyGsm &_modem) {
+    modem         = &_modem;
+    state         = ms_Off;
+    next_step_ms  = 0;
+    wait_start_ms = 0;
+    n_fails       = 0;
+    sub_step      = 0;
+}
+
+void Modem_Session::begin() {
+    DEBUG_NL(F("[Modem] Starting session.."))
+
+    n_fails = 0;
+    set_state(ms_Power_up, 0);
+}
+
+void Modem_Session::loop() {
+    uint32_t now = millis();
+
+    if (state == ms_Off || (int32_t)(now - next_step_ms) < 0)
+        return;                                            // The next step is not due yet
+
+    switch (state) {
+        case ms_Power_up:
+            wait_start_ms = now + MODEM_POWER_UP_MS;
+            sub_step = 0;
+            set_state(ms_Init, MODEM_POWER_UP_MS);         // Let the modem boot before talking to it
+            break;
+
+        case ms_Restart:                                   // Reset without waiting: the boot is waited in ms_Power_up
+            DEBUG_NL(F("[Modem] Restarting.."))
+            modem->sendAT(GF("+RST=1"));
+            modem->waitResponse(MODEM_AT_TIMEOUT_MS);
+            set_state(ms_Power_up, 0);
+            break;
+
+        case ms_Init:
+            if (sub_step == 0) {                           // Wait until the modem answers
+                if (modem->testAT(MODEM_AT_TIMEOUT_MS))
+                    sub_step = 1;
+                else if (now - wait_start_ms > MODEM_INIT_TIMEOUT_MS) {
+                    DEBUG_NL(F("[Modem] Init fail"))
+                    fail();
+                    break;
+                }
+                set_state(ms_Init, (sub_step == 0)? MODEM_NET_POLL_MS : 0);
+            }
+            else {                                         // Factory settings without echo (as TinyGsm init)
+                modem->sendAT(GF("&FZE0"));
+                if (modem->waitResponse(MODEM_AT_TIMEOUT_MS) == 1) {
+                    DEBUG_NL(F("[Modem] Init OK"))
+                    wait_start_ms = now;
+                    set_state(ms_Wait_net, 0);
+                }
+                else {
+                    DEBUG_NL(F("[Modem] Init fail"))
+                    fail();
+                }
+            }
+            break;
+
+        case ms_Wait_net:
+            if (modem->isNetworkConnected()) {
+                DEBUG_NL(F("[Modem] Network OK"))
+                sub_step = 0;
+                set_state(ms_Attach, 0);
+            }
+            else if (now - wait_start_ms > MODEM_NET_TIMEOUT_MS) {
+                DEBUG_NL(F("[Modem] Network fail"))
+                fail();
+            }
+            else
+                set_state(ms_Wait_net, MODEM_NET_POLL_MS);
+            break;
+
+        case ms_Attach:
+            if (sub_step == 0) {
+                modem->sendAT(GF("+CGATT=1"));             // Request the attach. The answer can take up to a minute
+                modem->waitResponse(MODEM_AT_TIMEOUT_MS);  // so it is not waited: the state is polled
+                sub_step = 1;
+                wait_start_ms = now;
+                set_state(ms_Attach, MODEM_NET_POLL_MS);
+            }
+            else if (is_attached()) {
+                sub_step = 0;
+                set_state(ms_Pdp_setup, 0);
+            }
+            else if (now - wait_start_ms > MODEM_GPRS_TIMEOUT_MS) {
+                DEBUG_NL(F("[Modem] GPRS attach fail"))
+                fail();
+            }
+            else
+                set_state(ms_Attach, MODEM_NET_POLL_MS);
+            break;
+
+        case ms_Pdp_setup:                                 // The same commands as TinyGsm gprsConnect(), one per step
+            switch (sub_step) {
+                case 0:
+                    modem->sendAT(GF("+CGDCONT=1,\"IP\",\""), GPRS_APN, '"');
+                    break;
+                case 1:
+                    modem->sendAT(GF("+CSTT=\""), GPRS_APN, GF("\",\""), GPRS_USER, GF("\",\""), GPRS_PASS, '"');
+                    break;
+                default:
+                    modem->sendAT(GF("+CGACT=1,1"));       // Activation, polled in ms_Wait_pdp
+                    break;
+            }
+            modem->waitResponse(MODEM_AT_TIMEOUT_MS);
+
+            if (++sub_step <= 2)
+                set_state(ms_Pdp_setup, 0);
+            else {
+                sub_step = 0;
+                wait_start_ms = now;
+                set_state(ms_Wait_pdp, MODEM_NET_POLL_MS);
+            }
+            break;
+
+        case ms_Wait_pdp:
+            if (sub_step > 0) {                            // PDP context active
+                modem->sendAT(GF("+CIPMUX=1"));            // Several connections (HTTP & MQTT clients)
+                modem->waitResponse(MODEM_AT_TIMEOUT_MS);
+                DEBUG_NL(F("[Modem] GPRS OK"))
+                n_fails = 0;
+                set_state(ms_Ready, MODEM_HEALTH_CHECK_MS);
+            }
+            else if (is_pdp_active()) {
+                sub_step = 1;
+                set_state(ms_Wait_pdp, 0);
+            }
+            else if (now - wait_start_ms > MODEM_GPRS_TIMEOUT_MS) {
+                DEBUG_NL(F("[Modem] GPRS fail"))
+                fail();
+            }
+            else
+                set_state(ms_Wait_pdp, MODEM_NET_POLL_MS);
+            break;
+
+        case ms_Ready:                                     // Periodic check of the link
+            if (is_pdp_active())
+                set_state(ms_Ready, MODEM_HEALTH_CHECK_MS);
+            else {
+                DEBUG_NL(F("[Modem] GPRS session lost"))
+                wait_start_ms = now;
+                set_state(ms_Wait_net, 0);                 // Only the lost layers are reestablished
+            }
+            break;
+
+        case ms_Backoff:                                   // A reset after repeated failures, otherwise a light init
+            if (n_fails % MODEM_RESTART_AFTER_FAILS == 0)
+                set_state(ms_Restart, 0);
+            else {
+                wait_start_ms = now;
+                sub_step = 0;
+                set_state(ms_Init, 0);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+bool Modem_Session::is_ready() {
+    return (state == ms_Ready);
+}
+
+void Modem_Session::report_failure() {
+    if (state == ms_Ready)
+        next_step_ms = millis();                           // Check the link in the next step
+}
+
+Modem_Session::Session_state_t Modem_Session::get_state() {
+    return state;
+}
+
+void Modem_Session::set_state(Session_state_t new_state, uint32_t delay_ms) {
+    state = new_state;
+    next_step_ms = millis() + delay_ms;
+}
+
+void Modem_Session::fail() {
+    if (n_fails < 255) n_fails++;
+
+    // Exponential backoff: min, 2*min, 4*min.. up to max
+    uint8_t shift = min(n_fails - 1, 8);
+    uint32_t backoff_s = min((uint32_t)MODEM_BACKOFF_MIN_S << shift, (uint32_t)MODEM_BACKOFF_MAX_S);
+
+    DEBUG_V2(F("[Modem] Next attempt in (s): "), backoff_s)
+
+    set_state(ms_Backoff, backoff_s * 1000);
+}
+
+bool Modem_Session::is_attached() {
+    modem->sendAT(GF("+CGATT?"));
+    int8_t res = modem->waitResponse(MODEM_AT_TIMEOUT_MS, GF("+CGATT:1"), GF("+CGATT: 1"),
+                                     GF("+CGATT:0"), GF("+CGATT: 0"));
+    if (res > 0) modem->waitResponse(MODEM_AT_TIMEOUT_MS);   // Final OK
+
+    return (res == 1 || res == 2);
+}
+
+bool Modem_Session::is_pdp_active() {
+    modem->sendAT(GF("+CGACT?"));
+    int8_t res = modem->waitResponse(MODEM_AT_TIMEOUT_MS, GF("+CGACT:1,1"), GF("+CGACT: 1,1"), GF("OK"));
+    if (res == 1 || res == 2) modem->waitResponse(MODEM_AT_TIMEOUT_MS);   // Final OK
+
+    return (res == 1 || res == 2);
+}
@@ -12,6 +12,8 @@
 
 ORP_Sensors::ORP_Sensors() {
 	n_sensors = 0;
+    req_pending = false;
+    req_start_ms = 0;
 
     for (uint8_t i=0; i<ORP_MAX_SENSORS; i++)
         val_sensors[i] = 0;
@@ -25,37 +27,77 @@ bool ORP_Sensors::add_sensor(uint8_t addr) {
     return true;
 }
 
-/* Capture temperatures & humidities from all ORP sensors */
+/* Capture millivolts from all ORP sensors */
 void ORP_Sensors::capture_all_sensors() {
-	for (uint8_t i=0; i<n_sensors; i++)
-        val_sensors[i] = get_mV(i);                        // Read millivolts signal
+    if (!request_all()) return;
+
+    while (!is_ready());                                   // Wait a single read window for all the probes
+    collect_all();
+}
+
+bool ORP_Sensors::request_all() {
+    if (n_sensors == 0) return false;
+
+    for (uint8_t i=0; i<n_sensors; i++)
+        send_command(addr_sensors[i], "r");                // All the probes start the reading at the same time
+
+    req_start_ms = millis();
+    req_pending = true;
+
+    return true;
+}
+
+bool ORP_Sensors::is_ready() {
+    if (!req_pending) return true;
+
+    return (millis() - req_start_ms >= ORP_MS_READ_TIME);
+}
+
+void ORP_Sensors::collect_all() {
+    for (uint8_t i=0; i<n_sensors; i++) {
+        val_sensors[i] = read_response(addr_sensors[i]);   // Read millivolts signal
+        send_command(addr_sensors[i], "sleep");            // enter in sleep mode for low energy comsumption
+    }
+
+    req_pending = false;
 }
 
 const int16_t ORP_Sensors::get_mV(uint8_t n_sensor) {
     if (n_sensor >= n_sensors) return -9999;
 
-    Wire.beginTransmission(addr_sensors[n_sensor]);        // call the circuit by its ID number.
-    Wire.write('r');                                       // transmit the command that was sent through the serial port.
-    Wire.endTransmission();                                // end the I2C data transmission.
-    delay(900);                                            // wait the correct amount of time for the circuit to complete its instruction.
+    send_command(addr_sensors[n_sensor], "r");
+    delay(ORP_MS_READ_TIME);                               // wait the correct amount of time for the circuit to complete its instruction.
 
-    Wire.requestFrom((int)addr_sensors[n_sensor], 20, 1);  // call the circuit and request 20 bytes (this may be more than we need)
-    uint8_t result_code = Wire.read();                     // the first byte is the response code, we read this separately.
-    Wire.write("sleep");                                   // enter in sleep mode for low energy comsumption
-    
-    if (result_code != 1)
-        return -9999;
+    int16_t result = read_response(addr_sensors[n_sensor]);
+    send_command(addr_sensors[n_sensor], "sleep");         // enter in sleep mode for low energy comsumption
+
+    return result;
+}
 
+void ORP_Sensors::send_command(uint8_t addr, const char *cmd) {
+    Wire.beginTransmission(addr);                          // call the circuit by its ID number.
+    Wire.write(cmd);                                       // transmit the command.
+    Wire.endTransmission();                                // end the I2C data transmission.
+}
+
+const int16_t ORP_Sensors::read_response(uint8_t addr) {
     char ORP_data[10];
     uint8_t i = 0;
+
+    Wire.requestFrom((int)addr, 20, 1);                    // call the circuit and request 20 bytes (this may be more than we need)
+    uint8_t result_code = Wire.read();                     // the first byte is the response code, we read this separately.
+
     while (Wire.available()) {                             // are there bytes to receive.
-        ORP_data[i] = Wire.read();                         // load this byte into our array.
-        if (ORP_data[i] == 0) {                            // if we see that we have been sent a null command.
-            Wire.endTransmission();                        // end the I2C data transmission.
-            break;                                         // exit the while loop.
-        }
-        i++;                                               // incur the counter for the array element.
+        char c = Wire.read();
+        if (c == 0) break;                                 // if we see that we have been sent a null command, exit the while loop.
+        if (i < sizeof(ORP_data)-1) ORP_data[i++] = c;     // load this byte into our array.
     }
+    ORP_data[i] = '\0';
+
+    while (Wire.available()) Wire.read();                  // discard the rest of the requested bytes
+
+    if (result_code != 1)
+        return -9999;
 
     return atoi(ORP_data);
 }
@@ -64,19 +106,27 @@ const uint8_t ORP_Sensors::get_n_sensors() {
     return n_sensors;
 }
 
-void ORP_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
+bool ORP_Sensors::start_capture() {
+    return request_all();
+}
 
-    for (uint8_t i=0; i<n_sensors; i++) {
-        if (i && delim != '\0') str.concat(delim);
+bool ORP_Sensors::poll_capture() {
+    if (!is_ready()) return false;
 
-        if (print_tag) {                                   // Ambient temperature
-            str.concat(F("ORP"));
-            str += i+1;
+    collect_all();
+    return true;
+}
 
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(val_sensors[i]);
-    }
+const uint8_t ORP_Sensors::get_n_channels() {
+    return n_sensors;
+}
+
+Channel_type_t ORP_Sensors::get_channel_type(uint8_t ch) {
+    return ct_ORP;
+}
+
+const float ORP_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= n_sensors) return 0;
+
+    return val_sensors[ch];
 }
@@ -0,0 +1,155 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * OS_Scheduler class used to run the sensors acquisition as cooperative tasks.
+ * Each task runs the start/poll phases of a sensor, so the main loop can keep
+ * attending other jobs (web server, MQTT keepalive, LCD) while the sensors convert.
+ * Every task has its own sampling period (rate group), so a cycle only launches the due tasks
+ *
+ */
+
+#include "OS_Scheduler.h"
+
+extern bool DEBUG;
+
+
+OS_Scheduler::OS_Scheduler() {
+    n_tasks        = 0;
+    n_pending      = 0;
+    n_fresh        = 0;
+    cycle_start_ms = 0;
+    cycle_ms       = 0;
+}
+
+int8_t OS_Scheduler::add_task(const __FlashStringHelper *name, uint16_t period_s, OS_Sensor *sensor,
+                              uint16_t timeout_ms) {
+    if (n_tasks >= SCHED_MAX_TASKS || sensor == NULL) return -1;
+    if (period_s < SCHED_MIN_PERIOD_S) period_s = SCHED_MIN_PERIOD_S;
+
+    tasks[n_tasks].name       = name;
+    tasks[n_tasks].sensor     = sensor;
+    tasks[n_tasks].timeout_ms = timeout_ms;
+    tasks[n_tasks].period_ms  = (uint32_t)period_s * 1000;
+    tasks[n_tasks].next_due_ms = millis();                 // Due on the first cycle
+    tasks[n_tasks].state      = st_Idle;
+    tasks[n_tasks].fresh      = false;
+    n_tasks++;
+
+    return n_tasks - 1;
+}
+
+uint8_t OS_Scheduler::start_cycle() {
+    cycle_start_ms = millis();
+    n_pending = 0;
+    n_fresh = 0;
+
+    for (uint8_t i=0; i<n_tasks; i++) {
+        tasks[i].fresh = false;
+
+        if (!is_due(i, cycle_start_ms)) {                  // Not its turn, the task keeps its last results
+            tasks[i].state = st_Idle;
+            continue;
+        }
+
+        // Keep the task on its own time grid. If a period has been lost, restart the grid from now
+        tasks[i].next_due_ms += tasks[i].period_ms;
+        if (is_due(i, cycle_start_ms))
+            tasks[i].next_due_ms = cycle_start_ms + tasks[i].period_ms;
+
+        // Tasks with something to capture become running
+        if (tasks[i].sensor->start_capture()) {
+            tasks[i].state = st_Running;
+            n_pending++;
+        } else {
+            tasks[i].state = st_Done;
+        }
+    }
+
+    if (n_pending == 0) cycle_ms = 0;
+
+    return n_pending;
+}
+
+bool OS_Scheduler::run() {
+    for (uint8_t i=0; i<n_tasks && n_pending > 0; i++) {
+        if (tasks[i].state != st_Running) continue;
+
+        if (tasks[i].sensor->poll_capture())
+            finish_task(i, false);                         // The task has all its results
+        else if (millis() - cycle_start_ms >= tasks[i].timeout_ms) {
+            tasks[i].sensor->abort_capture();              // Deadline expired, abandon the task
+            finish_task(i, true);
+        }
+    }
+
+    return (n_pending == 0);
+}
+
+bool OS_Scheduler::is_running() {
+    return (n_pending > 0);
+}
+
+OS_Scheduler::Task_state_t OS_Scheduler::get_task_state(uint8_t n_task) {
+    if (n_task >= n_tasks) return st_Idle;
+
+    return tasks[n_task].state;
+}
+
+bool OS_Scheduler::is_fresh(int8_t n_task) {
+    if (n_task < 0 || n_task >= n_tasks) return false;
+
+    return tasks[n_task].fresh;
+}
+
+const uint8_t OS_Scheduler::get_n_fresh() {
+    return n_fresh;
+}
+
+uint32_t OS_Scheduler::get_ms_to_next_due() {
+    uint32_t now = millis();
+    uint32_t min_ms = 0xFFFFFFFF;
+
+    if (n_tasks == 0)                                      // No sensors (e.g. SD config not loaded): wait a default period
+        return (uint32_t)DELAY_SECS_NEXT_READ * 1000;
+
+    for (uint8_t i=0; i<n_tasks; i++) {
+        if (is_due(i, now)) return 0;
+
+        uint32_t remain_ms = tasks[i].next_due_ms - now;
+        if (remain_ms < min_ms) min_ms = remain_ms;
+    }
+
+    return min_ms;
+}
+
+const uint8_t OS_Scheduler::get_n_tasks() {
+    return n_tasks;
+}
+
+const uint8_t OS_Scheduler::get_n_pending() {
+    return n_pending;
+}
+
+const uint32_t OS_Scheduler::get_cycle_ms() {
+    return cycle_ms;
+}
+
+void OS_Scheduler::finish_task(uint8_t n_task, bool timed_out) {
+    tasks[n_task].state = timed_out? st_Timeout : st_Done;
+    tasks[n_task].fresh = !timed_out;
+    if (!timed_out) n_fresh++;
+
+    if (DEBUG) {
+        SERIAL_MON.print(F("  > Task ")); SERIAL_MON.print(tasks[n_task].name);
+        SERIAL_MON.print(timed_out? F(" TIMEOUT at ") : F(" done at "));
+        SERIAL_MON.print(millis() - cycle_start_ms); SERIAL_MON.println(F(" ms"));
+    }
+
+    if (--n_pending == 0) cycle_ms = millis() - cycle_start_ms;
+}
+
+bool OS_Scheduler::is_due(uint8_t n_task, uint32_t now) {
+    return (int32_t)(now - tasks[n_task].next_due_ms) >= 0;   // Safe with the millis() overflow
+}
@@ -20,6 +20,53 @@ enum Internet_cnn_type : uint8_t {
 	it_Wifi
 };
 
+/*
+ * Encodings of the telemetry payload
+ */
+enum Payload_enc_t : uint8_t {
+    pe_text = 0,                                           // InfluxDB line protocol
+    pe_cbor,                                               // CBOR with the absolute values
+    pe_cbor_delta                                          // CBOR with the differences against the previous sample
+};
+
+/*
+ * Sensors groups. Each group is sampled at its own period
+ */
+enum Sensor_group_t : uint8_t {
+    sg_Current = 0,
+    sg_WP_temp,
+    sg_pH,
+    sg_ORP,
+    sg_DHT,
+    sg_Lux,
+    sg_DO,
+    sg_CO2,
+    sg_N_groups
+};
+
+/*
+ * Types of the channels published by the sensors
+ * The metadata of each type (tag, unit, precision) is defined in the sensor registry
+ */
+enum Channel_type_t : uint8_t {
+    ct_Current = 0,
+    ct_Energy,
+    ct_WP_temp_s,
+    ct_WP_temp_b,
+    ct_pH,
+    ct_ORP,
+    ct_Amb_temp,
+    ct_Amb_hum,
+    ct_Lux,
+    ct_DO_preLux,
+    ct_DO_Red,
+    ct_DO_Green,
+    ct_DO_Blue,
+    ct_DO_White,
+    ct_CO2,
+    ct_N_types
+};
+
 /*
  * Culture identification structure
  * Identify a specific culture
@@ -40,6 +87,8 @@ struct MQTT_Cnn_st {
     uint16_t port;
     char usr[21]; 
     char psw[21];
+    uint8_t batch_size;                                    // Samples published in each message
+    Payload_enc_t encoding;                                // Encoding of the payload
 };
 
 #endif
@@ -19,11 +19,15 @@ PH_Sensors::PH_Sensors() {
 };
 
 bool PH_Sensors::add_sensor(uint8_t pin) {
-    if (n_sensors < PH_MAX_NUM_SENSORS) {
-        pin_sensors[n_sensors++] = pin;
-        return true;
-    } else
-        return false;
+    if (n_sensors >= PH_MAX_NUM_SENSORS) return false;
+
+    int8_t ch = adc_engine.add_channel(pin);               // The pin is sampled in background by the ADC engine
+    if (ch < 0) return false;
+    adc_engine.set_ring_interval(ch, PH_SENS_MS_INTERV);   // The filter spans n_samples * PH_SENS_MS_INTERV
+
+    adc_ch[n_sensors] = ch;
+    pin_sensors[n_sensors++] = pin;
+    return true;
 }
 
 void PH_Sensors::capture_all_sensors() {
@@ -34,18 +38,8 @@ void PH_Sensors::capture_all_sensors() {
 const float PH_Sensors::get_sensor_value(uint8_t n_sensor) {
     if (n_sensor >= n_sensors) return 0;                   // If n_sensor is out of bounds for number of sensors attached, return 0
 
-    float read_v, min_v=0, max_v=0, total_v=0;
-    for (uint8_t i=n_samples; i>0; i--) {
-        read_v = analogRead(pin_sensors[n_sensor]);
-        total_v += read_v;
-
-        if (read_v < min_v) min_v = read_v;                // Update de min value
-        if (read_v > max_v) max_v = read_v;                // Update de max value
-        delay(10);
-    }
-
-    total_v = total_v - min_v - max_v;                     // Discards lower and higher value for the average
-    total_v /= (n_samples-2);
+    // Mean of the latest samples, discarding lower and higher value for the average
+    float total_v = adc_engine.get_trimmed_mean(adc_ch[n_sensor], n_samples);
     
     float pH_value = (float)total_v * 5.0 / 1024;          // Convert the analog into millivolt
     pH_value *= 3.5;                                       // Convert the millivolt into pH value
@@ -65,18 +59,21 @@ const uint8_t PH_Sensors::get_n_samples() {
     return n_samples;
 }
 
-void PH_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
-    
-    for (uint8_t i=0; i<n_sensors; i++) {
-        if (i && delim != '\0') str.concat(delim);
-        if (print_tag) {
-            str.concat("pH");
-            str += i+1;
-
-            if (print_value) str.concat("=");
-        }
-        if (print_value) str.concat(arr_results[i]);
-    }
+bool PH_Sensors::poll_capture() {
+    capture_all_sensors();
+    return true;
+}
+
+const uint8_t PH_Sensors::get_n_channels() {
+    return n_sensors;
+}
+
+Channel_type_t PH_Sensors::get_channel_type(uint8_t ch) {
+    return ct_pH;
+}
+
+const float PH_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= n_sensors) return 0;
+
+    return arr_results[ch];
 }
@@ -0,0 +1,33 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Print_Counter class used to measure the output of the print() calls without sending it.
+ * The web server renders the dynamic pages twice, first over a Print_Counter to get the
+ * Content-Length (needed by the keep-alive connections) and then over the client
+ *
+ */
+
+#include "Print_Counter.h"
+
+
+Print_Counter::Print_Counter() {
+    count = 0;
+}
+
+size_t Print_Counter::write(uint8_t c) {
+    count++;
+
+    return 1;
+}
+
+size_t Print_Counter::write(const uint8_t *buffer, size_t size) {
+    count += size;
+
+    return size;
+}
+
+const size_t Print_Counter::get_count() const {
+    return count;
+}
@@ -0,0 +1,72 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Record_Writer class used to compose the sensors records without dynamic memory.
+ * It is a Print sink over a fixed char buffer supplied by the caller, so all the
+ * print() overloads can be used to format the values. The text is kept null-terminated
+ * and the writes that do not fit in the buffer are discarded (marking the overflow)
+ *
+ */
+
+#include "Record_Writer.h"
+
+
+Record_Writer::Record_Writer(char *_buff, size_t _size) {
+    buff = _buff;
+    size = _size;
+    reset();
+}
+
+size_t Record_Writer::write(uint8_t c) {
+    if (c == '\0') return 0;                               // The record is a C string
+
+    if (len + 1 >= size) {                                 // Always keep room for the terminator
+        overflow = true;
+        return 0;
+    }
+
+    buff[len++] = c;
+    buff[len] = '\0';
+
+    return 1;
+}
+
+size_t Record_Writer::write(const uint8_t *buffer, size_t n) {
+    size_t n_written = 0;
+
+    while (n--) n_written += write(*buffer++);
+
+    return n_written;
+}
+
+void Record_Writer::reset() {
+    len = 0;
+    overflow = false;
+    if (size > 0) buff[0] = '\0';
+}
+
+void Record_Writer::truncate(size_t _len) {
+    if (_len >= len) return;
+
+    len = _len;
+    overflow = false;
+    buff[len] = '\0';
+}
+
+const char *Record_Writer::c_str() const {
+    return buff;
+}
+
+const size_t Record_Writer::length() const {
+    return len;
+}
+
+bool Record_Writer::is_empty() const {
+    return (len == 0);
+}
+
+bool Record_Writer::is_overflow() const {
+    return overflow;
+}
@@ -0,0 +1,107 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * SD_Logger class used to write the sensors records to the SD card keeping the file open.
+ * The records are accumulated in a sector buffer (512 bytes) and written to the card
+ * aligned to the sectors of the file. The directory entry is only updated (sync) every
+ * flush interval, so at most the records of that interval can be lost on a power failure
+ *
+ */
+
+#include "SD_Logger.h"
+
+extern bool DEBUG;
+
+
+SD_Logger::SD_Logger() {
+    opened        = false;
+    buff_len      = 0;
+    buff_limit    = SD_LOG_SECTOR_SIZE;
+    flush_ms      = (uint32_t)SD_LOG_DEF_FLUSH_SECS * 1000;
+    last_flush_ms = 0;
+}
+
+bool SD_Logger::begin(const char *filename, uint16_t flush_secs) {
+    if (opened) end();
+
+    log_file = SD.open(filename, FILE_WRITE);              // FILE_WRITE appends at the end of the file
+    if (!log_file) {
+        DEBUG_NL(F("[SD] Error opening log file!"))
+        return false;
+    }
+
+    opened        = true;
+    buff_len      = 0;
+    buff_limit    = SD_LOG_SECTOR_SIZE - (log_file.size() % SD_LOG_SECTOR_SIZE);   // Align with the sectors of the file
+    flush_ms      = (uint32_t)max(flush_secs, (uint16_t)1) * 1000;
+    last_flush_ms = millis();
+
+    DEBUG_V2(F("[SD] Log file open. Flush interval (s): "), flush_secs)
+
+    return true;
+}
+
+bool SD_Logger::write_record(const char *record) {
+    if (!opened) return false;
+
+    while (*record)
+        if (!write_byte(*record++)) return false;
+
+    return write_byte('\r') && write_byte('\n');
+}
+
+void SD_Logger::loop() {
+    if (opened && millis() - last_flush_ms >= flush_ms)
+        flush();
+}
+
+bool SD_Logger::flush() {
+    if (!opened) return false;
+
+    bool res = write_buffer();
+    log_file.flush();                                      // Update the directory entry (file size)
+    last_flush_ms = millis();
+
+    return res;
+}
+
+void SD_Logger::end() {
+    if (!opened) return;
+
+    flush();
+    log_file.close();
+    opened = false;
+}
+
+bool SD_Logger::is_open() {
+    return opened;
+}
+
+const uint16_t SD_Logger::get_buffered() {
+    return buff_len;
+}
+
+bool SD_Logger::write_byte(uint8_t c) {
+    buff[buff_len++] = c;
+
+    if (buff_len >= buff_limit)                            // The sector is complete, write it to the card
+        return write_buffer();
+
+    return true;
+}
+
+bool SD_Logger::write_buffer() {
+    if (buff_len == 0) return true;
+
+    size_t n_written = log_file.write(buff, buff_len);
+
+    uint16_t remain = buff_limit - buff_len;               // Bytes left to complete the sector of the file
+    buff_limit = remain? remain : SD_LOG_SECTOR_SIZE;
+    buff_len = 0;
+
+    if (n_written == 0) DEBUG_NL(F("[SD] Error writing log file!"))
+
+    return (n_written > 0);
+}
@@ -0,0 +1,158 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * SD_Queue class used to store on the SD card the records that could not be published.
+ * The queue is an append-only file (one record per line) with a read cursor saved in a
+ * second file, so the pending records survive the reboots. When all the records have
+ * been sent, both files are removed and the queue starts again from the beginning
+ *
+ */
+
+#include "SD_Queue.h"
+
+extern bool DEBUG;
+
+
+SD_Queue::SD_Queue() {
+    ready    = false;
+    max_size = (uint32_t)SD_QUEUE_DEF_MAX_KB * 1024;
+    cursor   = 0;
+    read_pos = 0;
+    n_read   = 0;
+    depth    = 0;
+}
+
+bool SD_Queue::begin(uint16_t max_kb) {
+    File file;
+    int c;
+
+    max_size = (uint32_t)max_kb * 1024;
+    cursor   = 0;
+    depth    = 0;
+
+    file = SD.open(SD_QUEUE_CURSOR_FILENAME, FILE_READ);  // Load the read cursor
+    if (file) {
+        while ((c = file.read()) >= '0' && c <= '9')
+            cursor = cursor * 10 + (c - '0');
+        file.close();
+    }
+
+    file = SD.open(SD_QUEUE_FILENAME, FILE_READ);          // Count the pending records (only on boot)
+    if (file) {
+        uint8_t buff[64];
+        int16_t n;
+
+        if (cursor > file.size()) cursor = file.size();
+        file.seek(cursor);
+
+        while ((n = file.read(buff, sizeof(buff))) > 0)
+            for (int16_t i=0; i < n; i++)
+                if (buff[i] == '\n') depth++;
+
+        file.close();
+    }
+
+    read_pos = cursor;
+    n_read   = 0;
+    ready    = true;
+
+    DEBUG_V2(F("[SD] Queue depth: "), depth)
+
+    return true;
+}
+
+bool SD_Queue::enqueue(const char *record) {
+    if (!ready || rd_file) return false;
+
+    File file = SD.open(SD_QUEUE_FILENAME, FILE_WRITE);
+    if (!file) {
+        DEBUG_NL(F("[SD] Error opening queue file!"))
+        return false;
+    }
+
+    if (file.size() >= max_size) {                         // Queue full. The oldest records are kept
+        DEBUG_NL(F("[SD] Queue full, record discarded"))
+        file.close();
+        return false;
+    }
+
+    file.println(record);
+    file.close();
+    depth++;
+
+    return true;
+}
+
+int16_t SD_Queue::read_next(char *buff, size_t size) {
+    if (!ready || n_read >= depth) return -1;
+
+    if (!rd_file) {
+        rd_file = SD.open(SD_QUEUE_FILENAME, FILE_READ);
+        if (!rd_file) return -1;
+
+        rd_file.seek(read_pos);
+    }
+
+    size_t len = 0;
+    int c;
+
+    while ((c = rd_file.read()) >= 0 && c != '\n') {
+        read_pos++;
+        if (c != '\r' && len + 1 < size) buff[len++] = c;
+    }
+    buff[len] = '\0';
+
+    if (c < 0) return -1;                                  // Incomplete record (end of file)
+
+    read_pos++;                                            // Line end
+    n_read++;
+
+    return len;
+}
+
+void SD_Queue::pop() {
+    if (n_read == 0) return;
+
+    cursor = read_pos;
+    depth--;
+    n_read = 0;                                            // Only the last record read can be popped
+}
+
+void SD_Queue::commit() {
+    if (rd_file) rd_file.close();
+
+    read_pos = cursor;
+    n_read   = 0;
+
+    if (!ready || cursor == 0) return;                     // Nothing sent
+
+    if (depth == 0) {                                      // Queue drained, start again from the beginning
+        SD.remove(SD_QUEUE_FILENAME);
+        SD.remove(SD_QUEUE_CURSOR_FILENAME);
+        cursor = read_pos = 0;
+        return;
+    }
+
+    save_cursor();
+}
+
+const uint32_t SD_Queue::get_depth() {
+    return depth;
+}
+
+bool SD_Queue::save_cursor() {
+    SD.remove(SD_QUEUE_CURSOR_FILENAME);                   // FILE_WRITE appends, so the cursor is rewritten
+
+    File file = SD.open(SD_QUEUE_CURSOR_FILENAME, FILE_WRITE);
+    if (!file) {
+        DEBUG_NL(F("[SD] Error saving queue cursor!"))
+        return false;
+    }
+
+    file.print(cursor);
+    file.close();
+
+    return true;
+}
@@ -0,0 +1,229 @@
+/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Autors: Sergio Arroyo (UOC)
+ *
+ * Sensor_Registry class used to handle all the sensors through a single table of channels.
+ * Each sensor registered becomes a scheduler task, and each of its values a channel.
+ * The channels are stored as a struct of arrays (type, number, owner & latest value),
+ * while the metadata of each channel type (tag, unit, precision & LCD label) lives in PROGMEM.
+ * Capture, publishing, logging and display iterate the same table
+ *
+ */
+
+#include "Sensor_Registry.h"
+
+/*
+ * Metadata of each channel type. In tags and labels '#' is replaced by the channel number
+ */
+struct Channel_meta_t {
+    char tag[9];                                           // Tag used to publish and log the channel
+    char unit[4];                                          // Unit of the value
+    uint8_t precision;                                     // Number of decimals of the value
+    char lcd_label[6];                                     // Label shown on the LCD ("" = not shown)
+};
+
+const Channel_meta_t CHANNEL_META[ct_N_types] PROGMEM = {
+    {"I#",      "A",   2, ""    },                         // ct_Current
+    {"E#",      "Wh",  2, ""    },                         // ct_Energy
+    {"T#_s",    "C",   2, "T#:" },                         // ct_WP_temp_s
+    {"T#_b",    "C",   2, ""    },                         // ct_WP_temp_b
+    {"pH#",     "pH",  2, "pH#:"},                         // ct_pH
+    {"ORP#",    "mV",  0, ""    },                         // ct_ORP
+    {"Amb#_t",  "C",   2, ""    },                         // ct_Amb_temp
+    {"Amb#_h",  "%",   2, ""    },                         // ct_Amb_hum
+    {"Lux#",    "lx",  0, ""    },                         // ct_Lux
+    {"DO_pLux", "lx",  2, ""    },                         // ct_DO_preLux
+    {"DO_R",    "lx",  2, ""    },                         // ct_DO_Red
+    {"DO_G",    "lx",  2, ""    },                         // ct_DO_Green
+    {"DO_B",    "lx",  2, ""    },                         // ct_DO_Blue
+    {"DO_W",    "lx",  2, ""    },                         // ct_DO_White
+    {"co2_#",   "ppm", 2, "CO2:"}                          // ct_CO2
+};
+
+
+Sensor_Registry::Sensor_Registry(OS_Scheduler *_sched) {
+    sched      = _sched;
+    n_sensors  = 0;
+    n_channels = 0;
+    n_updates  = 0;
+    update_time = 0;
+}
+
+bool Sensor_Registry::add_sensor(const __FlashStringHelper *name, OS_Sensor *sensor, uint16_t period_s,
+                                 uint16_t timeout_ms) {
+    if (sensor == NULL || n_sensors >= REG_MAX_SENSORS) return false;
+
+    uint8_t n_ch = sensor->get_n_channels();
+    if (n_channels + n_ch > REG_MAX_CHANNELS) return false;
+
+    int8_t task = sched->add_task(name, period_s, sensor, timeout_ms);
+    if (task < 0) return false;
+
+    sensors[n_sensors]       = sensor;
+    sens_task[n_sensors]     = task;
+    sens_first_ch[n_sensors] = n_channels;
+
+    for (uint8_t i=0; i<n_ch; i++) {                       // Add the channels of the sensor to the table
+        ch_type[n_channels]   = sensor->get_channel_type(i);
+        ch_num[n_channels]    = sensor->get_channel_num(i);
+        ch_sensor[n_channels] = n_sensors;
+        ch_value[n_channels]  = 0;
+        n_channels++;
+    }
+    n_sensors++;
+
+    return true;
+}
+
+void Sensor_Registry::update(uint32_t timestamp) {
+    for (uint8_t i=0; i<n_channels; i++) {
+        uint8_t s = ch_sensor[i];
+
+        if (sched->is_fresh(sens_task[s]))
+            ch_value[i] = sensors[s]->get_channel_value(i - sens_first_ch[s]);
+    }
+
+    n_updates++;
+    update_time = timestamp;
+}
+
+void Sensor_Registry::bulk_results(Record_Writer &out, bool print_tag, bool print_value, char delim, bool only_fresh) {
+    for (uint8_t i=0; i<n_channels; i++) {
+        if (only_fresh && !is_fresh(i)) continue;
+
+        if (!out.is_empty()) out.print(delim);             // If record is not empty, add delimiter
+        if (print_tag) {
+            print_channel_tag(out, i);
+            if (print_value) out.print(F("="));
+        }
+        if (print_value) out.print(ch_value[i], get_precision(i));
+    }
+}
+
+void Sensor_Registry::bulk_cbor(CBOR_Writer &out, int32_t *ref, bool delta, bool only_fresh) {
+    static const int32_t POW10[] = {1, 10, 100, 1000};
+
+    for (uint8_t i=0; i<n_channels; i++) {
+        if (only_fresh && !is_fresh(i)) continue;
+
+        float scaled = ch_value[i] * POW10[min(get_precision(i), (uint8_t)3)];
+
+        out.put_uint(get_channel_id(i));
+        if (isnan(scaled) || fabs(scaled) >= 2147483520.0) {   // NaN, inf or beyond int32 (lround is undefined)
+            out.put_null();
+            if (ref && !delta) ref[i] = 0;                 // The decoder has no absolute value either
+            continue;
+        }
+
+        int32_t value = lround(scaled);
+        out.put_int((delta && ref)? value - ref[i] : value);
+
+        if (ref) ref[i] = value;
+    }
+}
+
+void Sensor_Registry::bulk_json(Print &out) {
+    out.print('{');
+
+    for (uint8_t i=0; i<n_channels; i++) {
+        if (i > 0) out.print(',');
+
+        out.print('"');
+        print_channel_tag(out, i);
+        out.print(F("\":{\"value\":"));
+        if (isnan(ch_value[i]) || isinf(ch_value[i]))
+            out.print(F("null"));                          // NaN & inf are not valid JSON numbers
+        else
+            out.print(ch_value[i], get_precision(i));
+        out.print(F(",\"unit\":\""));
+        print_channel_unit(out, i);
+        out.print(F("\"}"));
+    }
+
+    out.print('}');
+}
+
+const uint32_t Sensor_Registry::get_update_count() {
+    return n_updates;
+}
+
+const uint32_t Sensor_Registry::get_update_time() {
+    return update_time;
+}
+
+const uint8_t Sensor_Registry::get_n_channels() {
+    return n_channels;
+}
+
+int8_t Sensor_Registry::find_channel(Channel_type_t type, uint8_t num) {
+    for (uint8_t i=0; i<n_channels; i++) {
+        if (ch_type[i] == type && ch_num[i] == num)
+            return i;
+    }
+
+    return -1;
+}
+
+Channel_type_t Sensor_Registry::get_type(uint8_t ch) {
+    if (ch >= n_channels) return ct_N_types;
+
+    return ch_type[ch];
+}
+
+const uint8_t Sensor_Registry::get_channel_id(uint8_t ch) {
+    if (ch >= n_channels) return 0;
+
+    return (ch_type[ch] << 4) | (ch_num[ch] & 0x0F);
+}
+
+const float Sensor_Registry::get_value(uint8_t ch) {
+    if (ch >= n_channels) return 0;
+
+    return ch_value[ch];
+}
+
+bool Sensor_Registry::is_fresh(uint8_t ch) {
+    if (ch >= n_channels) return false;
+
+    return sched->is_fresh(sens_task[ch_sensor[ch]]);
+}
+
+const uint8_t Sensor_Registry::get_precision(uint8_t ch) {
+    if (ch >= n_channels) return 0;
+
+    return pgm_read_byte(&CHANNEL_META[ch_type[ch]].precision);
+}
+
+void Sensor_Registry::print_channel_tag(Print &out, uint8_t ch) {
+    if (ch >= n_channels) return;
+
+    print_P_label(out, CHANNEL_META[ch_type[ch]].tag, ch_num[ch]);
+}
+
+void Sensor_Registry::print_channel_unit(Print &out, uint8_t ch) {
+    if (ch >= n_channels) return;
+
+    print_P_label(out, CHANNEL_META[ch_type[ch]].unit, ch_num[ch]);
+}
+
+bool Sensor_Registry::get_lcd_label(uint8_t ch, char *label, uint8_t size) {
+    if (ch >= n_channels || size == 0) return false;
+
+    const char *label_P = CHANNEL_META[ch_type[ch]].lcd_label;
+    if (pgm_read_byte(label_P) == '\0') return false;      // The channel is not shown on the LCD
+
+    Record_Writer writer(label, size);
+    print_P_label(writer, label_P, ch_num[ch]);
+
+    return true;
+}
+
+void Sensor_Registry::print_P_label(Print &out, const char *label_P, uint8_t num) {
+    char c;
+
+    while ((c = pgm_read_byte(label_P++)) != '\0') {
+        if (c == '#') out.print(num);
+        else out.print(c);
+    }
+}
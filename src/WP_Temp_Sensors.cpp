@@ -14,6 +14,9 @@ WP_Temp_Sensors::WP_Temp_Sensors(uint8_t oneWire_pin) {
     sensors_ds18 = new DallasTemperature(oneWireObj);
 	n_pairs = 0;
     initialized = false;
+    conv_pending = false;
+    conv_start_ms = 0;
+    conv_ms = 0;
     
     for (uint8_t i=0; i<WP_T_MAX_PAIRS_SENS; i++) {
         arr_s_results[i] = 0;
@@ -26,7 +29,8 @@ void WP_Temp_Sensors::begin() {
     initialized = true;
 }
 
-WP_Temp_Sensors::WP_Sensor_error_t WP_Temp_Sensors::add_sensors_pair(const uint8_t* s_sensor, const uint8_t* b_sensor) {
+WP_Temp_Sensors::WP_Sensor_error_t WP_Temp_Sensors::add_sensors_pair(const uint8_t* s_sensor, const uint8_t* b_sensor,
+                                                                     uint8_t resolution) {
     if (!sensors_ds18->isConnected(s_sensor)) return Surface_NotConn;     // If surface sensor not connected, return error
     if (!sensors_ds18->isConnected(b_sensor)) return Background_NotConn;  // If background sensor not connected, return error
     if (n_pairs >= WP_T_MAX_PAIRS_SENS) return Max_Reached;               // Controls that no more pairs of the allowed ones are inserted
@@ -36,17 +40,54 @@ WP_Temp_Sensors::WP_Sensor_error_t WP_Temp_Sensors::add_sensors_pair(const uint8
         sensors_pairs[n_pairs].b_sensor[i] = b_sensor[i];
     }
     n_pairs++;
+
+    resolution = constrain(resolution, 9, 12);                            // DS18B20 supports from 9 to 12 bits
+    sensors_ds18->setResolution(s_sensor, resolution);
+    sensors_ds18->setResolution(b_sensor, resolution);
+
+    uint16_t pair_ms = sensors_ds18->millisToWaitForConversion(resolution);
+    if (pair_ms > conv_ms) conv_ms = pair_ms;                             // The slowest pair sets the conversion time
     
     return No_Error;
 }
 
 void WP_Temp_Sensors::store_all_results() {
-    sensors_ds18->requestTemperatures();                   //Sends command for all devices on the bus to perform a temperature conversion
+    if (!request_conversion()) return;
+
+    while (!is_conversion_done());                         // Wait for the conversion time
+    collect_results();
+}
 
+bool WP_Temp_Sensors::request_conversion() {
+    if (n_pairs == 0) return false;
+
+    sensors_ds18->setWaitForConversion(false);             // Don't block the MCU during the conversion
+    sensors_ds18->requestTemperatures();                   // Sends command for all devices on the bus to perform a temperature conversion
+    sensors_ds18->setWaitForConversion(true);              // Restore the blocking mode for instant reads
+    
+    conv_start_ms = millis();
+    conv_pending = true;
+
+    return true;
+}
+
+bool WP_Temp_Sensors::is_conversion_done() {
+    if (!conv_pending) return true;
+
+    return (millis() - conv_start_ms >= conv_ms);
+}
+
+void WP_Temp_Sensors::collect_results() {
     for (uint8_t i=0; i<n_pairs; i++) {
         arr_s_results[i] = sensors_ds18->getTempC(sensors_pairs[i].s_sensor);
         arr_b_results[i] = sensors_ds18->getTempC(sensors_pairs[i].b_sensor);
     }
+
+    conv_pending = false;
+}
+
+const uint16_t WP_Temp_Sensors::get_conversion_ms() {
+    return conv_ms;
 }
 
 const float WP_Temp_Sensors::get_result_pair(uint8_t n_pair, WP_Temp_sensor_t sensor) {
@@ -87,29 +128,31 @@ bool WP_Temp_Sensors::is_init() {
     return initialized;
 }
 
-void WP_Temp_Sensors::bulk_results(String &str, bool reset, bool print_tag, bool print_value, char delim) {
-    if (reset) str.remove(0);                              // Delete string before entering the new values
-    if (str != "") str.concat(delim);                      // If string is not empty, add delimiter
-    
-    for (uint8_t i=0; i<n_pairs; i++) {
-        if (i && delim != '\0') str.concat(delim);         // Surface temperature
-        if (print_tag) {
-            str.concat(F("T"));
-            str += i+1;
-            str.concat(F("_s"));
-
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(arr_s_results[i]);
-        
-        str.concat(delim);                                 // Bacground temperature
-        if (print_tag) {
-            str.concat(F("T"));
-            str += i+1;
-            str.concat(F("_b"));
-
-            if (print_value) str.concat(F("="));
-        }
-        if (print_value) str.concat(arr_b_results[i]);
-    }
+bool WP_Temp_Sensors::start_capture() {
+    return request_conversion();
+}
+
+bool WP_Temp_Sensors::poll_capture() {
+    if (!is_conversion_done()) return false;
+
+    collect_results();
+    return true;
+}
+
+const uint8_t WP_Temp_Sensors::get_n_channels() {
+    return n_pairs * 2;
+}
+
+Channel_type_t WP_Temp_Sensors::get_channel_type(uint8_t ch) {
+    return (ch % 2)? ct_WP_temp_b : ct_WP_temp_s;
+}
+
+uint8_t WP_Temp_Sensors::get_channel_num(uint8_t ch) {
+    return ch / 2 + 1;
+}
+
+const float WP_Temp_Sensors::get_channel_value(uint8_t ch) {
+    if (ch >= n_pairs * 2) return 0;
+
+    return (ch % 2)? arr_b_results[ch / 2] : arr_s_results[ch / 2];
 }
@@ -15,6 +15,7 @@
 #include <SPI.h>
 #include <SD.h>
 #include <MemoryFree.h>
+#include <EEPROM.h>
 
 // OpenSpirulina libs
 #include "Load_SD_Config.h"                                // Read the initial configuration file
@@ -28,8 +29,19 @@
 #include "WP_Temp_Sensors.h"                               // Class for DS18 waterproof temperature sensors control
 #include "Current_Sensors.h"                               // Class for current sensors control
 #include "ORP_Sensors.h"                                   // Class for ORP (Oxydo Reduction Potential) sensors control
+#include "CO2_Sensors.h"                                   // Class for analog CO2 sensors control
 #include "MQTT_Pub.h"                                      // Class responsible for sending MQTT messaging to the remote broker
 #include "OS_Actuators.h"                                  // Class responsible for interacting with external devices (such as relays, etc.)
+#include "OS_Scheduler.h"                                  // Class responsible for running the acquisition tasks
+#include "ADC_Engine.h"                                    // Background sampling of the analog channels
+#include "Record_Writer.h"                                 // Compose the sensors records without dynamic memory
+#include "Sensor_Registry.h"                               // Table with the channels of all the sensors
+#include "SD_Logger.h"                                     // Buffered writes of the records to the SD card
+#include "SD_Queue.h"                                      // Records pending to publish (store & forward)
+#include "HTTP_Request.h"                                  // Bounded-memory parser of the web server requests
+#include "Print_Counter.h"                                 // Content-Length of the dynamic pages
+#include "Buffered_Client.h"                               // Coalesce the small writes into full TCP segments
+#include "Web_Assets.h"                                    // Static web pages, gzip compressed (tools/build_web_assets.py)
 
 
 /*****************
@@ -44,6 +56,13 @@ bool DEBUG = DEBUG_DEF_ENABLED;                            // Indicates whether
 bool LCD_enabled = LCD_DEF_ENABLED;                        // Indicates whether the LCD is active
 bool RTC_enabled = RTC_DEF_ENABLED;                        // Indicates whether the RTC is active
 bool SD_save_enabled = SD_SAVE_DEF_ENABLED;                // Indicates whether the save to SD is enabled
+bool SD_keep_open = SD_LOG_DEF_KEEP_OPEN;                  // Indicates whether the log file is kept open with buffered writes
+uint16_t SD_flush_secs = SD_LOG_DEF_FLUSH_SECS;            // Maximum time (in seconds) the records stay in the write buffer
+uint16_t SD_max_file_kb = SD_LOG_DEF_MAX_FILE_KB;          // Size (in KB) at which the log file is rotated (0 = no limit)
+bool SD_daily_rotate = SD_LOG_DEF_DAILY_ROTATE;            // Indicates whether a new log file is started every day (needs RTC)
+bool SD_queue_enabled = SD_QUEUE_DEF_ENABLED;              // Indicates whether the records not published are queued on SD
+uint16_t SD_queue_max_kb = SD_QUEUE_DEF_MAX_KB;            // Maximum size (in KB) of the queue file
+uint8_t SD_queue_batch = SD_QUEUE_DEF_BATCH;               // Maximum queued records published per cycle
 bool perf_pH_calib = false;                                // Indicates whether the calibration of the pH module should be carried out
 
 DateTime_RTC dateTimeRTC;                                  // RTC class object (DS3231 clock sensor)
@@ -59,11 +78,18 @@ PH_Sensors *pH_sensors;                                    // pH sensors class
 WP_Temp_Sensors *wp_t_sensors;                             // DS18B20 Sensors class
 Current_Sensors *curr_sensors;                             // Current sensors
 ORP_Sensors *orp_sensors;                                  // ORP sensors
-
-float array_CO2[CO2_DEF_NUM_SENSORS];                      // Array of CO2 sensors
+CO2_Sensors *co2_sensors;                                  // CO2 sensors
 
 File objFile;
 char fileName[SD_MAX_FILENAME_SIZE] = "";                  // Name of file to save data readed from sensors
+SD_Logger sd_logger;                                       // Keeps the log file open when SD_keep_open is enabled
+uint32_t SD_file_bytes = 0;                                // Bytes written to the current log file
+uint16_t SD_file_day = 0;                                  // Day (since epoch) in which the current log file was started
+SD_Queue sd_queue;                                         // Backlog of the records that could not be published
+
+char record_buff[RECORD_BUFF_SIZE];                        // Buffer where the sensors records are composed
+Record_Writer record(record_buff, sizeof(record_buff));    // Shared by the SD, MQTT & HTTP paths
+uint8_t net_tx_buff[NET_TX_BUFF_SIZE];                     // Coalesced output of the web server & the HTTP uplink
 
 Internet_cnn_type cnn_option = NET_DEF_CNN_TYPE;           // None | Ethernet | GPRS Modem | Wifi <-- Why not? Dream on it
 
@@ -74,65 +100,51 @@ char last_send[10] = "";
 uint16_t loop_count = 0;                                   // Count reading cycles
 
 MQTT_Pub *mqtt_pub;                                        // MQTT publisher client control
+EthernetClient eth_mqtt_cli;                               // Ethernet client of the MQTT broker connection
 OS_Actuators *os_actuators;                                // External actuators;
 EthernetServer *web_server;                                // WebServer responsible for attending external requests
 
+struct WebServer_slot_st {                                 // Connection with a WebServer client
+    EthernetClient client;
+    HTTP_Request request;                                  // Request being received
+    uint32_t idle_ms;                                      // Time of the connection or of the last response (idle keep-alive)
+    uint32_t req_start_ms;                                 // Time of the first byte of the request being received
+    bool receiving;                                        // A request has started to arrive
+    bool in_use;
+};
+WebServer_slot_st web_slots[ACT_WEBSRV_MAX_CLIENTS];       // Clients attended at the same time
+uint8_t web_n_slots = ACT_WEBSRV_MAX_CLIENTS;              // Slots usable with the free sockets of the Ethernet chip
+uint16_t web_boot_id = 0;                                  // Boot counter, so the ETags are not repeated after a reboot
+OS_Scheduler scheduler;                                    // Runs the sensors acquisition as cooperative tasks
+Sensor_Registry registry(&scheduler);                      // Channels of all the sensors, used to publish, log & display
+
+uint16_t sens_period[sg_N_groups] = {CURR_SENS_DEF_PERIOD_S, // Sampling period (in seconds) of each sensors group
+                                     WP_T_DEF_PERIOD_S,
+                                     PH_DEF_PERIOD_S,
+                                     ORP_DEF_PERIOD_S,
+                                     DHT_DEF_PERIOD_S,
+                                     LUX_SENS_DEF_PERIOD_S,
+                                     DO_SENS_DEF_PERIOD_S,
+                                     CO2_SENS_DEF_PERIOD_S};
+
 
 /*****************
  * METHODS
  *****************/
 
-/* Capture light ambient with LDR sensor*/
-float capture_LDR(uint8_t s_pin) {
-    return analogRead(s_pin);
-}
-
-/* Capture CO2 sensor */
-float capture_CO2(uint8_t pin) {
-    DEBUG_NL(F("Capturing CO2"))
-
-    int32_t total_v=0;
-    int16_t read_v, min_v=0, max_v=0;
-
-    for (uint8_t i=CO2_SENS_N_SAMP_READ; i>0; i--) {
-        read_v = analogRead(pin);                          // Read ADC value
-        read_v *= 5;                                       // Convert adc scale to voltage
-        read_v >>= 10;                                     // Shift 10 bits (divide by 1024)
-        read_v += 1420;                                    // Apply sensor offset
-
-        if (read_v < min_v) min_v = read_v;
-        if (read_v > max_v) max_v = read_v;
-        total_v += read_v;
-
-        delay(100);
-    }
-
-    total_v -= min_v;                                      // Discards lower and higher value for the average
-    total_v -= max_v;
-
-    return total_v / (CO2_SENS_N_SAMP_READ-2);
-}
-
-/* Show obteined vales from LCD */
+/* Show obteined vales from LCD. The channels with LCD label are shown in the order of the registry */
 void mostra_LCD() {
+    char label[6];
+    uint8_t n_shown = 0;
+
     lcd.clear();                        // Clear screen
 
-    // Shows on LCD the average of the two temperatures of  the first pair
-    if (wp_t_sensors && wp_t_sensors->get_n_pairs() > 0)
-        lcd.add_value_read("T1:", wp_t_sensors->get_result_pair(0, WP_Temp_Sensors::S_Both));
-    
-    // Shows on LCD the average of the two temperatures of  the first pair
-    if (wp_t_sensors && wp_t_sensors->get_n_pairs() > 1)
-        lcd.add_value_read("T2:", wp_t_sensors->get_result_pair(1, WP_Temp_Sensors::S_Both));
-    
-    if (pH_sensors && pH_sensors->get_n_sensors() > 0)
-        lcd.add_value_read("pH1:", pH_sensors->get_sensor_value(0));
-    
-    if (pH_sensors && pH_sensors->get_n_sensors() > 1)
-        lcd.add_value_read("pH2:", pH_sensors->get_sensor_value(1));
+    for (uint8_t i=0; i<registry.get_n_channels() && n_shown < REG_LCD_MAX_VALUES; i++) {
+        if (!registry.get_lcd_label(i, label, sizeof(label))) continue;
 
-    if (CO2_DEF_NUM_SENSORS > 0)
-        lcd.add_value_read("CO2:", array_CO2[0]);
+        lcd.add_value_read(label, registry.get_value(i));
+        n_shown++;
+    }
 }
 
 /* Capture data in calibration mode */
@@ -165,63 +177,42 @@ void pH_calibration() {
     }
 }
 
-/* Obtain the name of first free file for writting to SD */
-void SD_get_next_FileName(char* _fileName) {
-    static int fileCount = 0;
-
-    do {
-        sprintf(_fileName, "%06d.txt", ++fileCount);
-    } while (SD.exists(_fileName));
-}
-
 /**
- * Compose a string with all the results obtained from the sensors in specified format
+ * Obtain the name of the next file for writting to SD
+ * The index of the last file used is kept in the index file, so the name is found in constant
+ * time. Only when the index file does not exist (new card) the free names are probed from the
+ * first one. The index is updated before the file is created
  * 
- * @param str_out The string result with the specified format
- * @param print_tag Indicates whether the label of each sensor should be displayed
- * @param print_value Indicates whether the value of each sensor should be displayed
- * @param delim Character that indicates the separator of the fields shown
+ * @param _fileName Buffer where the name of the file is returned
  **/
-void compose_structure_results(String &str_out, bool print_tag, bool print_value, char delim) {
-    // Bulk current sensors tags: curr1#curr2#...
-    if (curr_sensors)
-        curr_sensors->bulk_results(str_out, false, print_tag, print_value, delim);
+void SD_get_next_FileName(char* _fileName) {
+    uint32_t fileCount = 0;
+    File idxFile = SD.open(SD_LOG_INDEX_FILENAME, FILE_READ);
 
-    // Bulk waterproof sensors tags: t1_s#t1_b#t2_s#t2_b#...
-    if (wp_t_sensors)
-        wp_t_sensors->bulk_results(str_out, false, print_tag, print_value, delim);
+    if (idxFile) {
+        int c;
 
-    // Bulk pH sensors
-    if (pH_sensors)
-        pH_sensors->bulk_results(str_out, false, print_tag, print_value, delim);
+        while ((c = idxFile.read()) >= '0' && c <= '9')    // Last index used
+            fileCount = fileCount * 10 + (c - '0');
+        idxFile.close();
+    }
 
-    // Bulk ORP sensors
-    if (orp_sensors)
-        orp_sensors->bulk_results(str_out, false, print_tag, print_value, delim);
+    do {                                                   // Normally only one step (stale index or new card)
+        if (++fileCount > SD_LOG_MAX_FILE_INDEX) fileCount = 1;
+        sprintf(_fileName, "%06lu.txt", (unsigned long)fileCount);
+    } while (SD.exists(_fileName));
 
-    // Bulk DHT sensors tags: at1#ah1#atn#ah2#...
-    if (dht_sensors.get_n_sensors() > 0)
-        dht_sensors.bulk_results(str_out, false, print_tag, print_value, delim);
+    SD.remove(SD_LOG_INDEX_FILENAME);                      // FILE_WRITE appends, so the index is rewritten
+    idxFile = SD.open(SD_LOG_INDEX_FILENAME, FILE_WRITE);
 
-    // Bulk lux sensors tags: lux1#lux2#...
-    if (lux_sensors)
-        lux_sensors->bulk_results(str_out, false, print_tag, print_value, delim);
-    
-    // Bulk DO sensor
-    if (do_sensor.is_init()) {
-        do_sensor.bulk_results(str_out, false, print_tag, print_value, delim);
-    }
-    
-    // Bulk CO2 sensors: co2_1#co2_2#...
-    if (CO2_DEF_NUM_SENSORS > 0) {
-        if (str_out != "") str_out.concat(F("#"));
-
-        for (uint8_t i=0; i<CO2_DEF_NUM_SENSORS; i++) {
-            if (i) str_out.concat(F("#"));
-            str_out.concat(F("co2_"));
-            str_out.concat(i);
-        }
+    if (idxFile) {
+        idxFile.print(fileCount);
+        idxFile.close();
     }
+    else
+        DEBUG_NL(F("Error opening SD index file!"))
+
+    DEBUG_V2(F("Log file: "), _fileName)
 }
 
 /**
@@ -234,34 +225,64 @@ void compose_structure_results(String &str_out, bool print_tag, bool print_value
  * @param delim Character that indicates the separator of the fields shown
  **/
 void SD_write_data(const char* _fileName, const bool print_tag, const bool print_value, const char delim) {
+    record.reset();
+
+    if (RTC_enabled) {                                     // Save datetime from RTC module
+        if (print_tag) record.print(F("DateTime"));
+        if (print_value) record.print(dateTimeRTC.getDateTime());
+    }
+
+    // Bulk all sensors information
+    registry.bulk_results(record, print_tag, print_value, delim);
+
+    DEBUG_V2(F("Write in file: "), record.c_str())
+    if (record.is_overflow()) DEBUG_V2(F("[!] WARNING! Record truncated to "), RECORD_BUFF_SIZE)
+
+    SD_file_bytes = (print_tag ? 0 : SD_file_bytes) + record.length() + 2;   // Headers start a new file
+
+    if (sd_logger.is_open()) {                             // Buffered write, the file stays open
+        sd_logger.write_record(record.c_str());
+        return;
+    }
+
     objFile = SD.open(_fileName, FILE_WRITE);              // Try to open file
 
     if (!objFile) {
         DEBUG_NL(F("Error opening SD file!"));
         return;    //Exit
     }
-        
-    String str_out = "";
+    
+    objFile.println(record.c_str());                       // Write the record to file
+    objFile.close();                                       // Close the file:
+}
 
-    if (RTC_enabled) {                                     // Save datetime from RTC module
-        if (print_tag) str_out.concat(F("DateTime"));
-        if (print_value) str_out.concat(dateTimeRTC.getDateTime());
+/**
+ * Start a new log file when the current one exceeds the maximum size or the day has changed
+ * The headers are written at the beginning of the new file
+ **/
+void SD_check_rotation() {
+    bool rotate = (SD_max_file_kb > 0 && SD_file_bytes >= (uint32_t)SD_max_file_kb * 1024);
+    
+    if (SD_daily_rotate && RTC_enabled) {
+        uint16_t day = dateTimeRTC.inc_unixtime(0) / 86400UL;
+
+        if (SD_file_day != 0 && day != SD_file_day) rotate = true;
+        SD_file_day = day;
     }
 
-    // Bulk all sensors information
-    compose_structure_results(str_out, print_tag, print_value, delim);
+    if (!rotate) return;
 
-    DEBUG_V2(F("Write in file: "), str_out)
-    
-    objFile.println(str_out);                              // Write the string result to file
-    objFile.close();                                       // Close the file:
+    DEBUG_NL(F("Rotating the SD log file"))
+    SD_get_next_FileName(fileName);
+
+    if (sd_logger.is_open()) sd_logger.begin(fileName, SD_flush_secs);  // Flush & close the current file
+    SD_write_data(fileName, true, false, SD_DATA_DELIMITED);              // Write File headers
 }
 
 bool send_data_http_server(EthernetClass *eth_if, char *host, uint16_t port) {
-	String str_out = "";
-	
-    // Bulk all sensors information
-    compose_structure_results(str_out, true, true, '&');   // Bulk all sensors information
+    // Bulk the information of the sensors captured in the last cycle
+    record.reset();
+    registry.bulk_results(record, true, true, '&', true);
 
 	// Send data to specific remote server
     switch (cnn_option) {
@@ -271,12 +292,12 @@ bool send_data_http_server(EthernetClass *eth_if, char *host, uint16_t port) {
                 cnn_init = ETH_initialize(eth_if, eth_mac);
                 if (!cnn_init) return false;
                 
-                return ETH_send_data_http_server(host, port, &str_out);
+                return ETH_send_data_http_server(host, port, record.c_str());
             }
             break;
         
         case it_GPRS:
-            return MODEM_send_data(&str_out, host, port);
+            return MODEM_send_data(record.c_str(), host, port);
             break;
         
         default: return false;                             // type not defined
@@ -285,46 +306,106 @@ bool send_data_http_server(EthernetClass *eth_if, char *host, uint16_t port) {
     return false;
 }
 
-bool send_data_mqtt_broker() {
-    String str_out = "";
-
-    // Bulk all sensors information
-    compose_structure_results(str_out, true, true, ',');   // Bulk all sensors information
-
-	// Send data to specific hardware
+/* Indicates whether the link used by the MQTT publisher is up */
+bool mqtt_link_ready() {
     switch (cnn_option) {
         case it_Ethernet:
-            return mqtt_pub->publish_topic(str_out.c_str());
-            break;
-        
+            return (mqtt_pub != NULL);
+
+        case it_GPRS:
+            return (mqtt_pub != NULL && MODEM_is_ready()); // Do not wait for the modem while the session is down
+
         default:
             return false;                                  // type not defined
     }
+}
+
+bool mqtt_publish_payload(const char *payload) {
+    if (!mqtt_link_ready()) return false;
+
+    return mqtt_pub->publish_topic(payload);
+}
+
+/**
+ * Publish the oldest records of the SD queue, up to SD_queue_batch per cycle so the
+ * fresh samples are never delayed. The drain stops at the first failure
+ **/
+void SD_drain_queue() {
+    uint8_t n_sent = 0;
+
+    while (n_sent < SD_queue_batch && sd_queue.read_next(record_buff, sizeof(record_buff)) >= 0) {
+        if (!mqtt_publish_payload(record_buff)) break;
+
+        sd_queue.pop();
+        n_sent++;
+    }
+
+    sd_queue.commit();                                     // Save the cursor once per batch
+    record.reset();                                        // The record buffer has been used to read the queue
+
+    if (n_sent > 0) DEBUG_V2(F("Queued records sent: "), n_sent)
+}
+
+bool send_data_mqtt_broker() {
+    uint32_t timestamp = RTC_enabled? dateTimeRTC.inc_unixtime(0) : 0;
+    int8_t res = MQTT_SAMPLE_REJECTED;
+
+    // Bulk the information of the sensors captured in the last cycle
+    record.reset();
+    registry.bulk_results(record, true, true, ',', true);
+
+    if (SD_queue_enabled) {                                // Report the backlog as a metric
+        record.print(F(",q_depth="));
+        record.print(sd_queue.get_depth());
+    }
+
+	// Send data through the Ethernet or GPRS client of the publisher
+    if (mqtt_link_ready()) {
+        if (mqtt_pub->get_encoding() != pe_text)           // Compact binary message
+            res = mqtt_pub->publish_cbor(registry, timestamp, SD_queue_enabled? sd_queue.get_depth() : -1)?
+                  MQTT_SAMPLE_SENT : MQTT_SAMPLE_REJECTED;
+        else
+            res = mqtt_pub->add_sample(record.c_str(), timestamp);   // Published alone or in a batch
+    }
+
+    if (res == MQTT_SAMPLE_SENT && sd_queue.get_depth() > 0)
+        SD_drain_queue();                                  // The broker is reachable, send the backlog
+
+    if (res != MQTT_SAMPLE_REJECTED) return true;
+
+    if (SD_queue_enabled) {                                // Keep the record with its timestamp to send it later
+        if (timestamp > 0) {
+            record.print(' ');
+            record.print(timestamp);                       // Line protocol timestamp (precision in seconds)
+        }
+
+        if (record.is_overflow() || !sd_queue.enqueue(record.c_str()))
+            DEBUG_NL(F("[!] WARNING! Record not queued"))
+    }
 
     return false;
 }
 
-uint8_t WebServer_process_action(String *str) {
-    int16_t pos;
+uint8_t WebServer_process_action(const char *query) {
     char dev_id[ACT_MAX_DEV_ID_LEN+1] = "";
+    const char *value;
     uint8_t dev_action;
 
-    pos = str->indexOf('?');                          // clean petition string
-    if (pos >= 0) str->remove(0, pos+1);
-    pos = str->indexOf('=');                          // Find where is the separator for the parameter and value
+    value = strchr(query, '=');                       // Find where is the separator for the parameter and value
 
-    if (pos == -1)                                    // If it does not contain an equal, it is not an action
+    if (value == NULL)                                // If it does not contain an equal, it is not an action
         return ACT_RES_PARAM_ERROR;
 
     // Extract device ID
-    strncpy(dev_id, str->substring(0, pos).c_str(), ACT_MAX_DEV_ID_LEN);
+    strncpy(dev_id, query, min((size_t)(value - query), (size_t)ACT_MAX_DEV_ID_LEN));
+    value++;
 
     // Check ON or OFF action
-    if (str->substring(pos+1).equalsIgnoreCase(F("ON"))) {
+    if (strcasecmp(value, "ON") == 0) {
         dev_action = HIGH;
-    } else if (str->substring(pos+1).equalsIgnoreCase(F("OFF"))) {
+    } else if (strcasecmp(value, "OFF") == 0) {
         dev_action = LOW;
-    } else if (str->substring(pos+1).equalsIgnoreCase(F("SWITCH"))) {
+    } else if (strcasecmp(value, "SWITCH") == 0) {
         dev_action = 0xFF;                            // Indicates that status switch han been requested
     } else {
         return ACT_RES_PARAM_ERROR;                   // If it isn't ON or OFF, return false
@@ -337,6 +418,7 @@ uint8_t WebServer_process_action(String *str) {
     
     if (os_actuators->change_state(dev_id, dev_action)) {
         DEBUG_NL(F("SUCCESS"))
+        if (mqtt_pub) mqtt_pub->publish_actuator_state(dev_id);   // Keep the retained state updated
         return ACT_RES_PROCESS_OK;
     } else {
         DEBUG_NL(F("ERROR"))
@@ -344,183 +426,339 @@ uint8_t WebServer_process_action(String *str) {
     }
 }
 
-void WebServer_generate_response(EthernetClient *eth_client, const __FlashStringHelper *code,
-                                 const __FlashStringHelper *msg) {
+/* Print the response headers. Without content type & length (-1) no body is announced (304) */
+void WebServer_print_headers(Client *eth_client, const __FlashStringHelper *code, const __FlashStringHelper *content_type,
+                             int32_t content_len, bool keep_alive, const char *etag = NULL, bool gzip = false) {
     eth_client->print(F("HTTP/1.1 ")); eth_client->println(code);
-    eth_client->println(F("Content-Type: text/html"));
+    if (content_type) {
+        eth_client->print(F("Content-Type: ")); eth_client->println(content_type);
+    }
+    if (gzip) {
+        eth_client->println(F("Content-Encoding: gzip"));
+        eth_client->println(F("Vary: Accept-Encoding"));
+    }
     eth_client->println(F("Access-Control-Allow-Origin: *"));
-    eth_client->println(F("Connection: close"));
+    if (etag) {
+        eth_client->print(F("ETag: ")); eth_client->println(etag);
+        eth_client->println(F("Cache-Control: no-cache"));           // Revalidate on each request
+    }
+    if (content_len >= 0) {
+        eth_client->print(F("Content-Length: ")); eth_client->println(content_len);
+    }
+    if (keep_alive)
+        eth_client->println(F("Connection: keep-alive"));
+    else
+        eth_client->println(F("Connection: close"));
     eth_client->println();
+}
+
+void WebServer_generate_response(Client *eth_client, const __FlashStringHelper *code,
+                                 const __FlashStringHelper *msg, bool keep_alive = false) {
+    WebServer_print_headers(eth_client, code, F("text/html"), strlen_P((PGM_P)msg) + 2, keep_alive);   // msg + CRLF
     eth_client->println(msg);
 }
 
-void WebServer_response_status(EthernetClient *eth_client, Culture_ID_st *culture_id, OS_Actuators *actuators) {
-    // Header
-    eth_client->println(F("HTTP/1.1 200 OK"));
-    eth_client->println(F("Content-Type: text/html"));
-    eth_client->println(F("Access-Control-Allow-Origin: *"));
-    eth_client->println(F("Connection: close"));
-    eth_client->println();
+/* Send a block of data stored in flash memory */
+void WebServer_write_P(Client *eth_client, const uint8_t *data_P, size_t len) {
+    uint8_t chunk[32];
 
-    // HTML init
-    eth_client->println(F("<!DOCTYPE HTML><html lang = ""en""><meta charset=""UTF-8"" /><head><title>State of the culture actuators</title>"));
-    eth_client->println(F("<style type=\"text/css\">"));
-    eth_client->println(F("*{font-family:sans-serif}table{width:100%;overflow:hidden;background:#FFF;color:#0373b5;border-collapse:collapse}table th,table td{padding:1em;}table th{border:1px solid #FFF;background-color:#0373b5;color:#FFF;text-align:left}table td{border:1px solid #b9e6ff}table tr:nth-child(odd){background-color:#daecf6}.ch_stat{cursor:pointer;text-decoration:underline}</style>"));
-    eth_client->println(F("<script>function send_act(act_id, action) {var xhr = new XMLHttpRequest(); xhr.timeout = 20000; xhr.open(\"GET\", \"/action?\"+ act_id +'='+ action, true);"));
-    eth_client->println(F("xhr.onload = function (e) { if (xhr.readyState === 4) { if (xhr.status === 200) { alert('Remote response: '+ xhr.responseText);location.reload(true);} else {alert('Error!! '+ xhr.statusText);}}};"));
-    eth_client->println(F("xhr.onerror = function (e) {alert('Error!! '+ xhr.statusText);}; xhr.send(null); } </script>"));
-    eth_client->println(F("</head><body>"));
-
-    // culture ID
-    eth_client->print(F("<h2>Culture:</h2><b>Country: </b> ")); eth_client->print(culture_id->country);
-    eth_client->print(F("<br><b>City: </b> ")); eth_client->print(culture_id->city);
-    eth_client->print(F("<br><b>Culture: </b>")); eth_client->print(culture_id->culture);
-    eth_client->print(F("<br><b>Host ID: </b>")); eth_client->print(culture_id->host_id);
-    eth_client->println(F("<br><br>"));
-    eth_client->println(F("<table><tr><th>Device ID</th><th>State</th><th colspan=\"2\">Change state</th></tr>"));
-
-    // print table of devices/actuators
-    const char *device_id;
-    for (uint8_t i=0; i < actuators->get_n_devices(); i++) {
-        eth_client->print(F("<tr><td>"));
-        device_id = actuators->get_device_id(i);
-        eth_client->print(device_id);
-        eth_client->print(F("</td><td>"));
-
-        // indicates if device is ON or OFF
-        if (actuators->get_device_state(i) == HIGH) {
-            eth_client->print(F("HIGH"));
-        } else {
-            eth_client->print(F("LOW"));
-        }
+    while (len > 0) {
+        size_t n = min(len, sizeof(chunk));
 
-        eth_client->print(F("</td><td class=\"ch_stat\" onclick='send_act(\""));
-        eth_client->print(device_id);
-        eth_client->print(F("\",\"ON\")'>Send ON</td><td class=\"ch_stat\" onclick='send_act(\""));
-        eth_client->print(device_id);
-        eth_client->print(F("\",\"OFF\")'>Send OFF</td></tr>"));
+        memcpy_P(chunk, data_P, n);
+        eth_client->write(chunk, n);
+        data_P += n;
+        len -= n;
     }
-    eth_client->print(F("</table></body><html>"));
 }
 
-void WebServer_check_petition() {
-    // Check if there are petitions
-    EthernetClient eth_client = web_server->available();
-    
-    // If the ethernet client does not have requests, exit function
-    if (!eth_client)
+/* Static page of the actuators, built from web/status.html and stored gzip compressed in flash.
+ * The page loads the culture ID & the state of the actuators from /api/status */
+void WebServer_response_status(Client *eth_client, HTTP_Request *request, bool keep_alive) {
+    if (request->is_etag_cached(WEB_STATUS_PAGE_GZ_ETAG)) {
+        WebServer_print_headers(eth_client, F("304 Not Modified"), NULL, -1, keep_alive, WEB_STATUS_PAGE_GZ_ETAG);
         return;
+    }
 
-    String str;
-    char c, c_prev = '\0';
-    int16_t pos;
-
-    while (eth_client.connected()) {
-        if (eth_client.available()) {
-            c = eth_client.read();
-            str.concat(c);
-
-            if (c == '\n' && c_prev == '\r') {                       // detect new line
-                str.trim();                                          // previus clean string
-                if (str.startsWith(F("GET "))) {
-                    pos = str.indexOf(' ');
-                    if (pos >= -1) str.remove(0, pos+1);             // remove GET method string
-                    pos = str.indexOf(' ');
-                    if (pos >= -1) str.remove(pos);                  // remove HTTP/1.1 string
-
-                    if (str.startsWith(ACT_WEBSRV_ACTIONS_STR)) {
-                        switch (WebServer_process_action(&str)) {
-                            case ACT_RES_PROCESS_OK:
-                                WebServer_generate_response(&eth_client, F("200 OK"), F("ACTION SUCCESS"));
-                                break;  // switch
-                            
-                            case ACT_RES_PARAM_ERROR:
-                                WebServer_generate_response(&eth_client, F("400 Bad Request"), F("PARAM. ERROR"));
-                                break;  // switch
-
-                            case ACT_RES_ACT_UNDEF:
-                                WebServer_generate_response(&eth_client, F("400 Bad Request"), F("ACTUATOR UNDEF."));
-                                break;  // switch
-                        }
-                        
-                    }
-                    else if (str.startsWith(ACT_WEBSRV_STATUS_STR)) {
-                        WebServer_response_status(&eth_client, &culture_ID, os_actuators);
-                    }
-                } else {
-                    // if request is not "/action?" or "/status" response unknown
-                    WebServer_generate_response(&eth_client, F("404 Not Found"), F("PETITION UNKNOWN"));
-                }
-
-                // emptying of the information transmitted by the client
-                // only the first line of request is of interest
-                while (eth_client.available()) 
-                    eth_client.read();
-                
-                break;    // exit while. from read data
-            }
-            c_prev = c;
+    if (!request->is_gzip_accepted()) {                    // There is no uncompressed copy
+        WebServer_generate_response(eth_client, F("406 Not Acceptable"), F("GZIP ENCODING REQUIRED"), keep_alive);
+        return;
+    }
+
+    WebServer_print_headers(eth_client, F("200 OK"), F("text/html"), WEB_STATUS_PAGE_GZ_LEN, keep_alive,
+                            WEB_STATUS_PAGE_GZ_ETAG, true);
+    WebServer_write_P(eth_client, WEB_STATUS_PAGE_GZ, WEB_STATUS_PAGE_GZ_LEN);
+}
+
+void WebServer_print_culture(Print *json, Culture_ID_st *culture_id) {
+    json->print(F("\"culture\":{\"country\":\"")); json->print(culture_id->country);
+    json->print(F("\",\"city\":\"")); json->print(culture_id->city);
+    json->print(F("\",\"culture\":\"")); json->print(culture_id->culture);
+    json->print(F("\",\"host_id\":\"")); json->print(culture_id->host_id);
+    json->print(F("\"}"));
+}
+
+void WebServer_print_api_status(Print *json, Culture_ID_st *culture_id, OS_Actuators *actuators) {
+    json->print('{');
+    WebServer_print_culture(json, culture_id);
+    json->print(F(",\"actuators\":["));
+
+    for (uint8_t i=0; i < actuators->get_n_devices(); i++) {
+        if (i > 0) json->print(',');
+        json->print(F("{\"id\":\"")); json->print(actuators->get_device_id(i));
+        json->print(F("\",\"state\":\""));
+        json->print((actuators->get_device_state(i) == HIGH)? F("HIGH") : F("LOW"));
+        json->print(F("\"}"));
+    }
+
+    json->print(F("]}"));
+}
+
+/* Data of the status page: culture ID & state of the actuators */
+void WebServer_response_api_status(Client *eth_client, Culture_ID_st *culture_id, OS_Actuators *actuators,
+                                   bool keep_alive) {
+    Print_Counter json_len;                                // The JSON is rendered twice to know its length
+
+    WebServer_print_api_status(&json_len, culture_id, actuators);
+    WebServer_print_headers(eth_client, F("200 OK"), F("application/json"), json_len.get_count(), keep_alive);
+    WebServer_print_api_status(eth_client, culture_id, actuators);
+}
+
+void WebServer_print_readings(Print *json, Culture_ID_st *culture_id) {
+    json->print(F("{\"cycle\":")); json->print(registry.get_update_count());
+    json->print(F(",\"timestamp\":"));
+    if (registry.get_update_time() > 0)
+        json->print(registry.get_update_time());
+    else
+        json->print(F("null"));                            // No RTC
+
+    json->print(',');
+    WebServer_print_culture(json, culture_id);
+    json->print(F(",\"readings\":"));
+    registry.bulk_json(*json);
+    json->print('}');
+}
+
+/* Latest values of the channels, from the table updated at the end of each capture cycle.
+ * The ETag changes with the cycle, so the clients that already have it get a 304 without body */
+void WebServer_response_readings(Client *eth_client, HTTP_Request *request, Culture_ID_st *culture_id,
+                                 bool keep_alive) {
+    char etag[24];
+
+    // The cycle count restarts on each boot (and the time is 0 without RTC), so the boot is part of the tag
+    sprintf(etag, "\"%u-%lu\"", web_boot_id, (unsigned long)registry.get_update_count());
+
+    if (request->is_etag_cached(etag)) {
+        WebServer_print_headers(eth_client, F("304 Not Modified"), NULL, -1, keep_alive, etag);
+        return;
+    }
+
+    Print_Counter json_len;
+
+    WebServer_print_readings(&json_len, culture_id);
+    WebServer_print_headers(eth_client, F("200 OK"), F("application/json"), json_len.get_count(), keep_alive, etag);
+    WebServer_print_readings(eth_client, culture_id);
+}
+
+/* Answer a complete request. Returns whether the connection must be kept open */
+bool WebServer_process_request(Client *eth_client, HTTP_Request *request) {
+    bool keep_alive = request->is_keep_alive();
+
+    if (!request->is_get()) {
+        WebServer_generate_response(eth_client, F("405 Method Not Allowed"), F("METHOD NOT ALLOWED"));
+        return false;                                      // The request body (if any) is not read
+    }
+    else if (request->target_starts_with(ACT_WEBSRV_ACTIONS_STR)) {
+        switch (WebServer_process_action(request->get_query())) {
+            case ACT_RES_PROCESS_OK:
+                WebServer_generate_response(eth_client, F("200 OK"), F("ACTION SUCCESS"), keep_alive);
+                break;  // switch
+            
+            case ACT_RES_PARAM_ERROR:
+                WebServer_generate_response(eth_client, F("400 Bad Request"), F("PARAM. ERROR"), keep_alive);
+                break;  // switch
+
+            case ACT_RES_ACT_UNDEF:
+                WebServer_generate_response(eth_client, F("400 Bad Request"), F("ACTUATOR UNDEF."), keep_alive);
+                break;  // switch
         }
     }
+    else if (request->target_starts_with(ACT_WEBSRV_STATUS_STR)) {
+        WebServer_response_status(eth_client, request, keep_alive);
+    }
+    else if (request->target_starts_with(ACT_WEBSRV_API_STATUS_STR)) {
+        WebServer_response_api_status(eth_client, &culture_ID, os_actuators, keep_alive);
+    }
+    else if (request->target_starts_with(ACT_WEBSRV_READINGS_STR)) {
+        WebServer_response_readings(eth_client, request, &culture_ID, keep_alive);
+    }
+    else {
+        // if request is not "/action?", "/status", "/api/status" or "/api/readings" response unknown
+        WebServer_generate_response(eth_client, F("404 Not Found"), F("PETITION UNKNOWN"), keep_alive);
+    }
 
-    delay(10);                                    // wait to client do 
-    eth_client.stop();                            // close connection
+    return keep_alive;
 }
 
-/* Capture the values of all available sensors */
-void capture_all_sensors() {
-    if (curr_sensors) {
-        DEBUG_NL(F("Capture current.."))
-        curr_sensors->capture_all_sensors();
+/* Release the socket of a client */
+void WebServer_close_slot(WebServer_slot_st *slot) {
+    // emptying of the information transmitted by the client (bounded by the socket RX buffer),
+    // so the connection is not reset before the response is received
+    while (slot->client.available())
+        slot->client.read();
+
+    slot->client.stop();
+    slot->in_use = false;
+}
+
+/* Parse the bytes received from a client and answer it when the request is complete */
+void WebServer_attend_slot(WebServer_slot_st *slot) {
+    HTTP_Request::Parse_result_t res = HTTP_Request::pr_Incomplete;
+    Buffered_Client out(slot->client, net_tx_buff, sizeof(net_tx_buff));   // The response is sent in a few segments
+    uint8_t n_read = 0;
+
+    // Parse the request as it arrives, without waiting for the rest of it. The limits are
+    // checked on each byte, so the too long requests are answered as soon as they are detected
+    while (res == HTTP_Request::pr_Incomplete && n_read < ACT_WEBSRV_MAX_READ && slot->client.available()) {
+        res = slot->request.feed(slot->client.read());
+        n_read++;
     }
-    WebServer_check_petition();                            // loop to check possible webserver petitions
 
-    // Si tenim sondes de temperatura
-    if (wp_t_sensors) {
-		DEBUG_NL(F("Capture WP temperatures.."))
-		wp_t_sensors->store_all_results();
-	}
-    WebServer_check_petition();                            // loop to check possible webserver petitions
-    
-	// Capture PH for each pH Sensor
-    if (pH_sensors) {
-        DEBUG_NL(F("Capture pH sensors.. "))
-        pH_sensors->capture_all_sensors();
+    if (n_read > 0 && !slot->receiving) {                  // The deadline of the request starts on its first byte
+        slot->receiving = true;
+        slot->req_start_ms = millis();
     }
-    WebServer_check_petition();                            // loop to check possible webserver petitions
 
-    if (orp_sensors) {
-        DEBUG_NL(F("Capture ORP sensors.. "))
-        orp_sensors->capture_all_sensors();
+    switch (res) {
+        case HTTP_Request::pr_Done:
+            if (WebServer_process_request(&out, &slot->request)) {
+                out.flush();
+                slot->request.reset();                     // Keep-alive: wait for the next request
+                slot->receiving = false;
+                slot->idle_ms = millis();
+            } else {
+                out.flush();
+                WebServer_close_slot(slot);
+            }
+            return;
+
+        case HTTP_Request::pr_URI_too_long:
+            WebServer_generate_response(&out, F("414 URI Too Long"), F("URI TOO LONG"));
+            out.flush();
+            WebServer_close_slot(slot);
+            return;
+
+        case HTTP_Request::pr_Bad_request:
+            WebServer_generate_response(&out, F("400 Bad Request"), F("BAD REQUEST"));
+            out.flush();
+            WebServer_close_slot(slot);
+            return;
+
+        default:
+            break;
     }
-    WebServer_check_petition();                            // loop to check possible webserver petitions
 
-    // Capture PH for each pH Sensor
-	if (dht_sensors.get_n_sensors() > 0) {
-		DEBUG_NL(F("Capture DHT sensors.."))
-		dht_sensors.capture_all_sensors();
-	}
-    WebServer_check_petition();                            // loop to check possible webserver petitions
+    if (!slot->client.connected()) {                       // Closed by the client
+        WebServer_close_slot(slot);
+    } else if (slot->receiving && millis() - slot->req_start_ms > ACT_WEBSRV_TIMEOUT_MS) {
+        DEBUG_NL(F("[!] HTTP request timeout"))            // The whole request must arrive in time (slow clients)
+        WebServer_close_slot(slot);
+    } else if (!slot->receiving && millis() - slot->idle_ms > ACT_WEBSRV_IDLE_MS) {
+        DEBUG_NL(F("[!] HTTP idle connection closed"))     // No request after the connection or the last response
+        WebServer_close_slot(slot);
+    }
+}
 
-    if (lux_sensors) {
-		DEBUG_NL(F("Capture lux sensor.."))
-		lux_sensors->capture_all_sensors();
-	}
-    WebServer_check_petition();                            // loop to check possible webserver petitions
+/* Accept the new clients and attend the open connections. It never waits for a client */
+void WebServer_check_petition() {
+    // Check if there is a new client. accept() returns each connection only once
+    EthernetClient new_client = web_server->accept();
+
+    if (new_client) {
+        uint8_t i = 0;
+
+        while (i < web_n_slots && web_slots[i].in_use) i++;
+
+        if (i < web_n_slots) {
+            web_slots[i].client  = new_client;
+            web_slots[i].request.reset();
+            web_slots[i].idle_ms   = millis();
+            web_slots[i].receiving = false;
+            web_slots[i].in_use    = true;
+        } else {                                           // Answered with the spare socket
+            Buffered_Client out(new_client, net_tx_buff, sizeof(net_tx_buff));
 
-    //Capture DO values (Red, Green, Blue, and White)
-    if (do_sensor.is_init()) {
-		DEBUG_NL(F("Capture DO sensor.."))
-        do_sensor.capture_DO();
+            WebServer_generate_response(&out, F("503 Service Unavailable"), F("SERVER BUSY"));
+            out.stop();
+        }
     }
-    WebServer_check_petition();                            // loop to check possible webserver petitions
-    
-    // Capture CO2 concentration
-    if (CO2_DEF_NUM_SENSORS > 0) {
-		DEBUG_NL(F("Capture CO2 sensor.."))
-		capture_CO2(CO2_SENS_DEF_PINS[0]);
-	}
-    WebServer_check_petition();                            // loop to check possible webserver petitions
+
+    for (uint8_t i=0; i < web_n_slots; i++)
+        if (web_slots[i].in_use)
+            WebServer_attend_slot(&web_slots[i]);
+}
+
+/* Attend the jobs that must keep running while the sensors are captured or waiting */
+void service_background_tasks() {
+    if (web_server)
+        WebServer_check_petition();                        // loop to check possible webserver petitions
+
+    if (mqtt_link_ready())
+        mqtt_pub->loop();                                  // MQTT keepalive (Ethernet or GPRS)
+
+    if (cnn_option == it_GPRS)
+        MODEM_loop();                                      // GPRS session (connection & link checks)
+
+    if (curr_sensors)
+        curr_sensors->poll_metering();                     // Irms & energy of the completed metering windows
+
+    sd_logger.loop();                                      // Sync the buffered records once the flush interval expires
+}
+
+/* Add to the registry the available sensors, each one captured at its own period */
+void register_sensors() {
+    if (curr_sensors)
+        registry.add_sensor(F("current"), curr_sensors, sens_period[sg_Current]);
+
+    if (wp_t_sensors)
+        registry.add_sensor(F("WP temp."), wp_t_sensors, sens_period[sg_WP_temp]);
+
+    if (pH_sensors)
+        registry.add_sensor(F("pH"), pH_sensors, sens_period[sg_pH]);
+
+    if (orp_sensors)
+        registry.add_sensor(F("ORP"), orp_sensors, sens_period[sg_ORP]);
+
+    if (dht_sensors.get_n_sensors() > 0)
+        registry.add_sensor(F("DHT"), &dht_sensors, sens_period[sg_DHT]);
+
+    if (lux_sensors)
+        registry.add_sensor(F("lux"), lux_sensors, sens_period[sg_Lux]);
+
+    if (do_sensor.is_init())
+        registry.add_sensor(F("DO"), &do_sensor, sens_period[sg_DO]);
+
+    if (co2_sensors)
+        registry.add_sensor(F("CO2"), co2_sensors, sens_period[sg_CO2]);
+}
+
+/**
+ * Capture the values of the sensors groups whose period has expired
+ *
+ * @return The number of groups with new results
+ **/
+uint8_t capture_all_sensors() {
+    if (scheduler.start_cycle() == 0)                      // Launch the due acquisition tasks
+        return 0;
+
+    while (!scheduler.run())                               // Advance the tasks until all have finished
+        service_background_tasks();
+
+    registry.update(RTC_enabled? dateTimeRTC.inc_unixtime(0) : 0);   // Store the new values in the table of channels
+
+    DEBUG_V3(F("Capture cycle: "), scheduler.get_cycle_ms(), F(" ms"))
+
+    return scheduler.get_n_fresh();
 }
 
 /* Wait a certain time validating if the calibration switch is pressed
@@ -552,7 +790,7 @@ bool wait_time_with_RTC(const uint16_t waiting_secs) {
             prev_S_millis = millis();
         }
 
-        WebServer_check_petition();                        // loop to check possible webserver petitions
+        service_background_tasks();                        // Attend webserver petitions & MQTT keepalive
     } while (time_diff > 0);
 
     return false;            // Exit without active de calibration switch
@@ -584,7 +822,7 @@ bool wait_time_no_RTC(const uint16_t waiting_secs) {
             prev_S_millis = millis();
         }
 
-        WebServer_check_petition();                        // loop to check possible webserver petitions
+        service_background_tasks();                        // Attend webserver petitions & MQTT keepalive
     }
 
     return false;            // Exit without active de calibration switch
@@ -618,6 +856,21 @@ void setup() {
                          buffer, INI_FILE_BUFFER_LEN, RTC_enabled);
             ini.getValue("SD_card", "save_on_sd",                         // Load if SD save is enabled
                          buffer, INI_FILE_BUFFER_LEN, SD_save_enabled);
+            ini.getValue("SD_card", "keep_open",                          // Load if the log file is kept open
+                         buffer, INI_FILE_BUFFER_LEN, SD_keep_open);
+            ini.getValue("SD_card", "flush_secs",                         // Load the flush interval of the log file
+                         buffer, INI_FILE_BUFFER_LEN, SD_flush_secs);
+            ini.getValue("SD_card", "max_file_kb",                        // Load the maximum size of the log file
+                         buffer, INI_FILE_BUFFER_LEN, SD_max_file_kb);
+            ini.getValue("SD_card", "daily_rotate",                       // Load if a new log file is started every day
+                         buffer, INI_FILE_BUFFER_LEN, SD_daily_rotate);
+            ini.getValue("SD_card", "queue_enabled",                      // Load if the records not published are queued
+                         buffer, INI_FILE_BUFFER_LEN, SD_queue_enabled);
+            ini.getValue("SD_card", "queue_max_kb",                       // Load the maximum size of the queue
+                         buffer, INI_FILE_BUFFER_LEN, SD_queue_max_kb);
+            if (ini.getValue("SD_card", "queue_batch",                    // Load the queued records published per cycle
+                             buffer, INI_FILE_BUFFER_LEN))
+                SD_queue_batch = atoi(buffer);
 
             SD_load_culture_ID(&ini, &culture_ID);                        // Load culture identification
             SD_load_Cnn_type(&ini, cnn_option);                           // Load connection type
@@ -627,26 +880,57 @@ void setup() {
                 cnn_init = ETH_initialize(&Ethernet, eth_mac);
             } 
             else if (cnn_option == it_GPRS) {
-                cnn_init = MODEM_connect_network();
+                MODEM_begin();                                            // The session is established in background
+                cnn_init = true;
             }
             
-            SD_load_MQTT_config(&ini, mqtt_pub, &culture_ID);             // Load MQTT connection information
+            if (cnn_option == it_GPRS) {                                  // Load MQTT connection information
+                SD_load_MQTT_config(&ini, mqtt_pub, &culture_ID, MODEM_get_mqtt_client());
+            }
+            else {
+                eth_mqtt_cli.setConnectionTimeout(MQTT_CONNECT_TIMEOUT_MS);   // Instead of the full TCP timeout
+                SD_load_MQTT_config(&ini, mqtt_pub, &culture_ID, eth_mqtt_cli);
+            }
 
-			SD_load_DHT_sensors(&ini, &dht_sensors);                      // Initialize DHT sensors configuration
-            SD_load_DO_sensor(&ini, &do_sensor);                          // Initialize DO sensor
-			SD_load_Lux_sensors(&ini, lux_sensors);                       // Initialize Lux light sensor
-            SD_load_pH_sensors(&ini, pH_sensors);                         // Initialize pH sensors
-            SD_load_ORP_sensors(&ini, orp_sensors);                       // Initialize ORP sensors
-            SD_load_WP_Temp_sensors(&ini, wp_t_sensors);                  // Initialize DS18B20 waterproof temperature sensors
-            SD_load_Current_sensors(&ini, curr_sensors);                  // Initialize current sensors
+			SD_load_DHT_sensors(&ini, &dht_sensors, sens_period[sg_DHT]);           // Initialize DHT sensors configuration
+            SD_load_DO_sensor(&ini, &do_sensor, sens_period[sg_DO]);                // Initialize DO sensor
+			SD_load_Lux_sensors(&ini, lux_sensors, sens_period[sg_Lux]);            // Initialize Lux light sensor
+            SD_load_pH_sensors(&ini, pH_sensors, sens_period[sg_pH]);               // Initialize pH sensors
+            SD_load_ORP_sensors(&ini, orp_sensors, sens_period[sg_ORP]);            // Initialize ORP sensors
+            SD_load_WP_Temp_sensors(&ini, wp_t_sensors, sens_period[sg_WP_temp]);   // Initialize DS18B20 waterproof temperature sensors
+            SD_load_Current_sensors(&ini, curr_sensors, sens_period[sg_Current]);   // Initialize current sensors
 
             SD_load_WebServerActuators(&ini, web_server, os_actuators);   // Initialize WebServer & external actuators
+
+            // Sockets of the Ethernet chip: the listener, a spare one to answer "busy" (503) when
+            // all the slots are in use, and the MQTT broker connection (if it goes over Ethernet)
+            int8_t n_free = ETH_N_SOCKETS - 2 - ((mqtt_pub && cnn_option == it_Ethernet)? 1 : 0);
+            web_n_slots = constrain(n_free, 1, ACT_WEBSRV_MAX_CLIENTS);
+
+            if (web_server) {                                             // Count the boots (a write per boot)
+                EEPROM.get(ACT_WEBSRV_BOOT_EE_ADDR, web_boot_id);
+                EEPROM.put(ACT_WEBSRV_BOOT_EE_ADDR, ++web_boot_id);
+            }
+
+            if (mqtt_pub && os_actuators)
+                mqtt_pub->set_actuators(os_actuators);                    // Actuators commands by MQTT
         }
+
+        if (SD_queue_enabled) sd_queue.begin(SD_queue_max_kb);            // Load the records pending to publish
 	}
 	else {
 		DEBUG_NL(F("Initialization SD failed!"))
 	}
 
+    if (CO2_DEF_NUM_SENSORS > 0) {                                        // CO2 sensors with the default configuration
+        co2_sensors = new CO2_Sensors();
+        for (uint8_t i=0; i<CO2_DEF_NUM_SENSORS; i++)
+            co2_sensors->add_sensor(CO2_SENS_DEF_PINS[i]);
+    }
+
+    register_sensors();                                                   // Prepare the acquisition of the loaded sensors
+    adc_engine.begin();                                                   // Start the background sampling of the analog channels
+
     // If DEBUG is active and Serial not initialized, then start this
     if (!DEBUG_DEF_ENABLED && DEBUG) SERIAL_MON.begin(SERIAL_BAUD);
         else if (DEBUG_DEF_ENABLED && !DEBUG) SERIAL_MON.end();
@@ -664,6 +948,7 @@ void setup() {
 	// If save in SD card option is enabled
 	if (SD_save_enabled) {
 		SD_get_next_FileName(fileName);                                   // Obtain the next file name to write
+        if (SD_keep_open) sd_logger.begin(fileName, SD_flush_secs);       // Open the log file for buffered writes
         SD_write_data(fileName, true, false, SD_DATA_DELIMITED);          // Write File headers
 	}
 
@@ -692,13 +977,13 @@ void loop() {
 	if (LCD_enabled)
 		lcd.print_msg_val(0, 3, "Getting data.. %d", (int32_t)loop_count);
 
-    // Capture the values of all available sensors
-    capture_all_sensors();
+    // Capture the values of the sensors groups that are due
+    uint8_t n_fresh = capture_all_sensors();
     
     // END of capturing values
     if (LCD_enabled) mostra_LCD();
     
-	if (cnn_option != it_none) {
+	if (cnn_option != it_none && n_fresh > 0) {
         if (DEBUG) SERIAL_MON.print(F("Sending data to server.. "));
 
         // Try to send the collected data to the remote broker
@@ -721,22 +1006,27 @@ void loop() {
         }
     }
     
-    WebServer_check_petition();                            // loop to check possible webserver petitions
+    service_background_tasks();                            // Attend webserver petitions & MQTT keepalive
 
-    // Save data to SD card
-    if (SD_save_enabled) SD_write_data(fileName, false, true, SD_DATA_DELIMITED);
+    // Save data to SD card. All the columns are written to keep the file format, with the last value of each group
+    if (SD_save_enabled && n_fresh > 0) {
+        SD_check_rotation();                               // New file when the size or day limit is reached
+        SD_write_data(fileName, false, true, SD_DATA_DELIMITED);
+    }
 
-	// Waiting time until the next reading
+	// Waiting time until the next sensors group is due
+    uint16_t wait_secs = (scheduler.get_ms_to_next_due() + 999) / 1000;
     if (RTC_enabled)
-        perf_pH_calib = wait_time_with_RTC(DELAY_SECS_NEXT_READ);
+        perf_pH_calib = wait_time_with_RTC(wait_secs);
     else
-        perf_pH_calib = wait_time_no_RTC(DELAY_SECS_NEXT_READ);
+        perf_pH_calib = wait_time_no_RTC(wait_secs);
 
     // If the pH switch is active, perform the calibration iteration
     if (perf_pH_calib || digitalRead(PH_CALIBRATION_SWITCH_PIN) == HIGH) {
         DEBUG_NL(F("\n[!] Calibration switch active."))
 
         if (perf_pH_calib) perf_pH_calib = false;
+        sd_logger.flush();                                 // Nothing stays in memory while the loop is stopped
         pH_calibration();
     }
 }
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+"""
+OpenSpirulina http://www.openspirulina.com
+
+Build the static assets of the web server: the files of web/ are compressed with gzip
+and written as PROGMEM arrays to include/Web_Assets.h, so the firmware sends them as
+they are (Content-Encoding: gzip). Each asset gets an ETag (CRC32 of the data).
+
+The header is only rewritten when an asset is newer, so it can be run on each build:
+    platformio.ini:  extra_scripts = pre:tools/build_web_assets.py
+    or by hand:      python3 tools/build_web_assets.py
+"""
+
+import gzip
+import os
+import sys
+import zlib
+
+# (source file in web/, C name of the array)
+ASSETS = [
+    ("status.html", "WEB_STATUS_PAGE_GZ"),
+]
+
+HEADER = "include/Web_Assets.h"
+
+
+def minify(text):
+    """Remove the indentation, blank lines & whole-line comments (the line ends are kept)"""
+    lines = []
+    for line in text.splitlines():
+        line = line.strip()
+        if line and not line.startswith("//"):
+            lines.append(line)
+    return "\n".join(lines) + "\n"
+
+
+def c_array(name, data):
+    out = ["const uint8_t %s[] PROGMEM = {" % name]
+    for i in range(0, len(data), 16):
+        out.append("    " + ", ".join("0x%02x" % b for b in data[i:i + 16]) + ",")
+    out.append("};")
+    return "\n".join(out)
+
+
+def build(project_dir):
+    header = os.path.join(project_dir, HEADER)
+    sources = [os.path.join(project_dir, "web", src) for src, _ in ASSETS]
+
+    if os.path.exists(header) and \
+       all(os.path.getmtime(src) <= os.path.getmtime(header) for src in sources):
+        return False                                       # Up to date
+
+    blocks = []
+    for (src, name), path in zip(ASSETS, sources):
+        with open(path, encoding="utf-8") as f:
+            raw = minify(f.read()).encode("utf-8")
+        data = gzip.compress(raw, compresslevel=9, mtime=0)   # mtime=0: same output on each build
+        define_len = ("#define %s_LEN %d" % (name, len(data))).ljust(59)
+        define_etag = ("#define %s_ETAG \"\\\"%08x\\\"\"" % (name, zlib.crc32(data))).ljust(59)
+        blocks.append("%s// %s: %d bytes (%d uncompressed)\n%s// Changes with the content\n%s" % (
+            define_len, src, len(data), len(raw), define_etag, c_array(name, data)))
+
+    with open(header, "w", encoding="utf-8") as f:
+        f.write("""/**
+ * OpenSpirulina http://www.openspirulina.com
+ *
+ * Static assets of the web server, gzip compressed.
+ * GENERATED by tools/build_web_assets.py from web/ -- do not edit
+ *
+ */
+#ifndef Web_Assets_h
+#define Web_Assets_h
+
+#include <Arduino.h>
+
+%s
+
+#endif
+""" % "\n\n".join(blocks))
+
+    print("Web assets written to %s" % HEADER)
+    return True
+
+
+try:
+    Import("env")                                          # noqa: F821 (PlatformIO pre-build script)
+    build(env.subst("$PROJECT_DIR"))                       # noqa: F821
+except NameError:
+    if __name__ == "__main__":
+        build(os.path.dirname(os.path.dirname(os.path.abspath(sys.argv[0]))))
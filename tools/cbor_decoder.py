@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""
+OpenSpirulina http://www.openspirulina.com
+
+Decoder of the CBOR telemetry messages (encoding = cbor | cbor_delta in [rpt:MQTT]).
+Converts the messages published on <host_id>/sensors/cbor to InfluxDB line protocol,
+the same records sent with the text encoding.
+
+Message (CBOR map):
+    0: sequence number          1: timestamp (UNIX time in seconds, optional)
+    2: [country, city, culture] (key messages)
+    3: [id, value, ...]         absolute values (fixed point, value * 10^precision)
+    4: [id, diff, ...]          differences against the last value of each channel
+                                (null if the channel has no valid value, e.g. a sensor read error)
+    5: SD queue depth (optional)
+
+The channel ID is type * 16 + number. The types & precisions must match CHANNEL_META
+in src/Sensor_Registry.cpp.
+
+Usage:
+    cbor_decoder.py --broker 192.168.1.42 [--port 1883]    Subscribe to +/sensors/cbor
+    cbor_decoder.py --host-id HOST FILE [FILE ...]         Decode messages saved in files
+
+Needs: cbor2 (and paho-mqtt to subscribe to the broker)
+"""
+
+import argparse
+import sys
+
+import cbor2
+
+MEASUREMENT = "sensors"                                    # INFLUXDB_MEASUREMENT
+
+# (tag, precision) of each channel type, in the order of Channel_type_t
+CHANNEL_META = [
+    ("I#", 2),                                             # ct_Current
+    ("E#", 2),                                             # ct_Energy
+    ("T#_s", 2),                                           # ct_WP_temp_s
+    ("T#_b", 2),                                           # ct_WP_temp_b
+    ("pH#", 2),                                            # ct_pH
+    ("ORP#", 0),                                           # ct_ORP
+    ("Amb#_t", 2),                                         # ct_Amb_temp
+    ("Amb#_h", 2),                                         # ct_Amb_hum
+    ("Lux#", 0),                                           # ct_Lux
+    ("DO_pLux", 2),                                        # ct_DO_preLux
+    ("DO_R", 2),                                           # ct_DO_Red
+    ("DO_G", 2),                                           # ct_DO_Green
+    ("DO_B", 2),                                           # ct_DO_Blue
+    ("DO_W", 2),                                           # ct_DO_White
+    ("co2_#", 2),                                          # ct_CO2
+]
+
+
+class HostState:
+    """State of the deltas of a board (one per host_id)"""
+
+    def __init__(self):
+        self.tags = None                                   # (country, city, culture)
+        self.ref = {}                                      # Last value of each channel ID (fixed point)
+        self.next_seq = None
+        self.synced = False                                # False until a key message is received
+
+
+def channel_tag(ch_id):
+    ch_type, num = ch_id >> 4, ch_id & 0x0F
+
+    if ch_type >= len(CHANNEL_META):
+        return "ch%d" % ch_id, 2
+
+    tag, precision = CHANNEL_META[ch_type]
+    return tag.replace("#", str(num)), precision
+
+
+def decode(payload, host_id, state):
+    """Decode a message. Returns the line protocol record, or None if it can not be decoded"""
+    msg = cbor2.loads(payload)
+    seq = msg.get(0)
+
+    if state.next_seq is not None and seq != state.next_seq:
+        state.synced = False                               # Lost messages, wait for the next key message
+    state.next_seq = (seq + 1) & 0xFFFF
+
+    if 2 in msg:
+        state.tags = tuple(msg[2])
+
+    if 3 in msg:
+        pairs = msg[3]
+        if 2 in msg:                                       # Key messages carry all the channels
+            state.ref = {}
+            state.synced = True
+        for ch_id, value in zip(pairs[0::2], pairs[1::2]):
+            state.ref[ch_id] = 0 if value is None else value   # Same reference as the board
+    elif 4 in msg:
+        if not state.synced:
+            return None
+        pairs = msg[4]
+        for ch_id, diff in zip(pairs[0::2], pairs[1::2]):
+            if diff is not None:                           # Null keeps the reference
+                state.ref[ch_id] = state.ref.get(ch_id, 0) + diff
+    else:
+        pairs = []
+
+    fields = []
+    for ch_id, value in zip(pairs[0::2], pairs[1::2]):
+        if value is None:
+            continue                                       # Line protocol has no null, the field is omitted
+        tag, precision = channel_tag(ch_id)
+        fields.append("%s=%.*f" % (tag, precision, state.ref[ch_id] / 10.0 ** precision))
+
+    if 5 in msg:
+        fields.append("q_depth=%d" % msg[5])
+
+    if not fields or state.tags is None:
+        return None                                        # Without the tags InfluxDB rejects the record
+
+    country, city, culture = state.tags
+    record = "%s,country=%s,city=%s,culture=%s,host=%s %s" % (
+        MEASUREMENT, country, city, culture, host_id, ",".join(fields))
+
+    if 1 in msg:
+        record += " %d" % msg[1]                           # Precision in seconds
+
+    return record
+
+
+def subscribe(broker, port):
+    import paho.mqtt.client as mqtt
+
+    states = {}
+
+    def on_message(client, userdata, message):
+        host_id = message.topic.split("/")[0]
+        record = decode(message.payload, host_id, states.setdefault(host_id, HostState()))
+        if record:
+            print(record, flush=True)
+
+    client = mqtt.Client()
+    client.on_message = on_message
+    client.connect(broker, port)
+    client.subscribe("+/sensors/cbor")
+    client.loop_forever()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the OpenSpirulina CBOR telemetry")
+    parser.add_argument("--broker", help="MQTT broker to subscribe to")
+    parser.add_argument("--port", type=int, default=1883, help="MQTT broker port")
+    parser.add_argument("--host-id", default="", help="host_id of the messages read from files")
+    parser.add_argument("files", nargs="*", help="Files with one binary message each, in order")
+    args = parser.parse_args()
+
+    if args.broker:
+        subscribe(args.broker, args.port)
+    elif args.files:
+        state = HostState()
+        for name in args.files:
+            with open(name, "rb") as f:
+                record = decode(f.read(), args.host_id, state)
+            if record:
+                print(record)
+    else:
+        parser.print_help()
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())